@@ -35,6 +35,29 @@
 	#endif
 #endif
 
+//! Set to 0 to make allocator::allocate_at_least always return the requested count
+#ifndef OEL_HAS_MALLOC_USABLE_SIZE
+	#if OEL_HAS_FREE_SIZED
+	#define OEL_HAS_MALLOC_USABLE_SIZE  0 // free_sized must be passed the size that was requested
+	#elif OEL_HAS_SDALLOCX or defined __GLIBC__ or defined __APPLE__
+	#define OEL_HAS_MALLOC_USABLE_SIZE  1
+	#else
+	#define OEL_HAS_MALLOC_USABLE_SIZE  0
+	#endif
+#endif
+
+#if OEL_HAS_MALLOC_USABLE_SIZE and !OEL_HAS_SDALLOCX
+	#ifdef __APPLE__
+	#include <malloc/malloc.h>
+	#else
+	#include <malloc.h>
+	#endif
+#endif
+
+#if __cpp_lib_allocate_at_least >= 202302
+#include <memory>
+#endif
+
 #ifndef OEL_MALLOC_ALIGNMENT
 #define OEL_MALLOC_ALIGNMENT  __STDCPP_DEFAULT_NEW_ALIGNMENT__
 #endif
@@ -49,6 +72,19 @@
 namespace oel
 {
 
+#if __cpp_lib_allocate_at_least >= 202302
+	using std::allocation_result;
+#else
+	//! Same as std::allocation_result (C++23)
+	template< typename Pointer, typename SizeType = size_t >
+	struct allocation_result
+	{
+		Pointer  ptr;
+		SizeType count;
+	};
+#endif
+
+
 //! Has `reallocate` function in addition to standard functionality
 /**
 * Either throws std::bad_alloc or calls standard new_handler on failure, depending on value of OEL_NEW_HANDLER.
@@ -71,10 +107,19 @@ public:
 
 	//! `count` greater than max_size() causes overflow and undefined behavior
 	static T *  allocate(size_t count);
+	//! Same as std::allocator::allocate_at_least (C++23), count of result is what malloc actually made usable
+	/**
+	* The count of the result (or any count between that and the passed count) is valid to pass to deallocate.
+	* Result is always the passed count if OEL_HAS_MALLOC_USABLE_SIZE is 0 or T is over-aligned. */
+	static allocation_result<T *> allocate_at_least(size_t count);
+	//! Like allocate, but the memory is all zero bytes. Uses calloc, which gets fresh pages lazily zeroed by the OS
+	static T *  allocate_zeroed(size_t count);
 
 	//! Like C23 `realloc` except for failure handling (same as allocate, throws bad_alloc or calls new_handler)
 	/** @pre If newCount is zero or greater than max_size(), the behavior is undefined  */
 	static T *  reallocate(T * ptr, size_t newCount);
+	//! Combines reallocate and allocate_at_least
+	static allocation_result<T *> reallocate_at_least(T * ptr, size_t newCount);
 
 	static void deallocate(T * ptr, size_t count) noexcept;
 
@@ -98,6 +143,8 @@ private:
 	{
 		return alignof(T) > OEL_MALLOC_ALIGNMENT ? alignof(T) : OEL_MALLOC_ALIGNMENT;
 	}
+
+	static allocation_result<T *> _atLeast(T * p, size_t count) noexcept;
 };
 
 namespace _detail
@@ -145,6 +192,22 @@ namespace _detail
 		}
 	};
 
+	template< size_t Align >
+	struct Calloc
+	{
+		static void * call(size_t const nBytes)
+		{
+			if constexpr( Align > OEL_MALLOC_ALIGNMENT )
+			{
+				auto p = ::calloc(1, nBytes + Align);
+				return AlignAndStore<Align>(p);
+			}
+			else
+			{	return ::calloc(1, nBytes);
+			}
+		}
+	};
+
 	template< size_t Align >
 	struct Realloc
 	{
@@ -184,6 +247,27 @@ namespace _detail
 	#endif
 	}
 
+	// Number of bytes that can be used in block p returned by malloc(nBytes), with nBytes != 0
+	inline size_t UsableSize([[maybe_unused]] void * p, [[maybe_unused]] size_t const nBytes) noexcept
+	{
+	#if !OEL_HAS_MALLOC_USABLE_SIZE
+		return nBytes;
+	#elif OEL_HAS_SDALLOCX
+		return ::nallocx(nBytes, 0);
+	#elif defined __APPLE__
+		return ::malloc_size(p);
+	#else
+		return ::malloc_usable_size(p);
+	#endif
+	}
+
+	// Returns p, but tells the compiler that the block has nBytes. Else it would only see the size passed to
+	// malloc, and warn about (or with _FORTIFY_SOURCE, abort on) access to the rest of the usable size
+#ifdef __GNUC__
+	[[gnu::alloc_size(2), gnu::returns_nonnull, gnu::noinline]]
+#endif
+	inline void * ExpandToUsable(void * p, size_t) noexcept  { return p; }
+
 	template
 	<	typename AllocFunc,
 		bool CheckZero = true,
@@ -233,6 +317,18 @@ template< typename T >
 	return static_cast<T *>( _detail::AllocAndHandleFail<F>(sizeof(T) * count) );
 }
 
+template< typename T >
+#ifdef __GNUC__
+[[gnu::malloc]]
+#endif
+[[nodiscard]] T * allocator<T>::allocate_zeroed(size_t count)
+{
+	OEL_ASSERT(count <= max_size());
+
+	using F = _detail::Calloc<_alignment()>;
+	return static_cast<T *>( _detail::AllocAndHandleFail<F>(sizeof(T) * count) );
+}
+
 template< typename T >
 [[nodiscard]] T * allocator<T>::reallocate(T * ptr, size_t count)
 {
@@ -243,6 +339,33 @@ template< typename T >
 	return static_cast<T *>( _detail::AllocAndHandleFail<F, /*CheckZero*/ false>(sizeof(T) * count, vp) );
 }
 
+template< typename T >
+inline allocation_result<T *> allocator<T>::_atLeast(T * p, size_t count) noexcept
+{
+	if constexpr( _alignment() == OEL_MALLOC_ALIGNMENT )
+	{
+		if( count != 0 ) // malloc may return null for zero size, and nallocx has undefined behavior
+		{
+			auto const nBytes = _detail::UsableSize(p, sizeof(T) * count);
+			p = static_cast<T *>( _detail::ExpandToUsable(p, nBytes) );
+			count = nBytes / sizeof(T);
+		}
+	}
+	return {p, count};
+}
+
+template< typename T >
+inline allocation_result<T *> allocator<T>::allocate_at_least(size_t count)
+{
+	return _atLeast(allocate(count), count);
+}
+
+template< typename T >
+inline allocation_result<T *> allocator<T>::reallocate_at_least(T * ptr, size_t count)
+{
+	return _atLeast(reallocate(ptr, count), count);
+}
+
 template< typename T >
 inline void allocator<T>::deallocate(T * ptr, size_t count) noexcept
 {
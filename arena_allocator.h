@@ -0,0 +1,184 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "allocator.h"
+#include "auxi/bump_chunks.h"
+
+#include <cstddef>
+#include <cstring>
+
+/** @file
+*/
+
+namespace oel
+{
+
+//! Bump allocator that hands out memory from chunks obtained with malloc, and frees them all at once
+/**
+* Growing the most recent allocation is done in place while the current chunk has room, so a dynarray
+* that is appended to between other allocations does not leave a trail of abandoned blocks.
+* Deallocating the most recent allocation gives back its space, other deallocations do nothing.
+*
+* Meant for many short-lived containers, such as those built while handling one request.
+* Use together with arena_allocator. Not thread-safe. */
+class arena
+{
+public:
+	//! The first chunk is allocated lazily, and will be at least initialChunkBytes
+	explicit arena(size_t initialChunkBytes = 4096) noexcept
+	 :	_bump{initialChunkBytes} {}
+
+	arena(const arena &) = delete;
+	arena & operator =(const arena &) = delete;
+
+	~arena()  { _bump.rewind(nullptr, nullptr, _freeChunk); }
+
+	//! Alignment must be a power of two. Throws std::bad_alloc or calls new_handler on failure, like oel::allocator
+	[[nodiscard]] void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+	//! Extends or shrinks in place if p is the most recent allocation and the chunk has room, else copies
+	/** @param p must have been allocated from *this with oldBytes and alignment, or be null */
+	[[nodiscard]] void * reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment = alignof(std::max_align_t));
+	//! Only reclaims the space if p is the most recent allocation
+	void deallocate(void * p, size_t bytes) noexcept;
+
+	//! Makes all memory allocated from the arena available again, without returning the newest chunk to malloc
+	/** All blocks allocated before become invalid, so no container using the arena may be destroyed afterwards. */
+	void reset() noexcept;
+
+	class frame;
+
+	//! Total bytes in the chunks held, including what is not handed out
+	size_t chunk_bytes() const noexcept  { return _bump.chunkBytes(); }
+
+private:
+	using _chunkHeader = _detail::BumpChunks::Header;
+
+	_detail::BumpChunks _bump;
+
+	static void * _getChunk(size_t size);
+	static void   _freeChunk(_chunkHeader * c) noexcept;
+};
+
+//! Marks the state of an arena, then rewinds to that when destroyed, freeing everything allocated meanwhile
+/**
+* Frames must be destroyed in reverse order of construction. The containers that got memory from the arena
+* during the lifetime of a frame must be destroyed before it. */
+class arena::frame
+{
+public:
+	explicit frame(arena & a) noexcept
+	 :	_arena{a}, _chunk{a._bump.chunks}, _cur{a._bump.cur} {}
+
+	frame(const frame &) = delete;
+	frame & operator =(const frame &) = delete;
+
+	~frame()  { _arena._bump.rewind(_chunk, _cur, _freeChunk); }
+
+private:
+	arena &        _arena;
+	_chunkHeader * _chunk;
+	std::byte *    _cur;
+};
+
+//! Allocator that gets memory from an oel::arena, and has `reallocate` for dynarray to grow in place
+/**
+* Does not own the arena, which must outlive all containers using the allocator.
+* Moving a container moves the allocator with it, copy assignment does not. */
+template< typename T >
+class arena_allocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_move_assignment = std::true_type;
+
+	static constexpr bool   can_reallocate() noexcept { return is_trivially_relocatable<T>::value; }
+
+	static constexpr size_t max_size() noexcept       { return SIZE_MAX / sizeof(T) / 2; }
+
+	arena_allocator(arena & a) noexcept : _arena{&a} {}
+
+	template< typename U >
+	arena_allocator(const arena_allocator<U> & other) noexcept
+	 :	_arena{&other.get_arena()} {}
+
+	[[nodiscard]] T * allocate(size_t count)
+		{
+			OEL_ASSERT(count <= max_size());
+			return static_cast<T *>( _arena->allocate(sizeof(T) * count, alignof(T)) );
+		}
+	//! oldCount must be the count that ptr was allocated with
+	[[nodiscard]] T * reallocate(T * ptr, size_t oldCount, size_t newCount)
+		{
+			OEL_ASSERT(newCount <= max_size());
+			return static_cast<T *>( _arena->reallocate(ptr, sizeof(T) * oldCount, sizeof(T) * newCount, alignof(T)) );
+		}
+
+	void deallocate(T * ptr, size_t count) noexcept
+		{
+			_arena->deallocate(ptr, sizeof(T) * count);
+		}
+
+	arena & get_arena() const noexcept  { return *_arena; }
+
+	template< typename U >
+	friend bool operator==(arena_allocator a, arena_allocator<U> b) noexcept  { return &a.get_arena() == &b.get_arena(); }
+	template< typename U >
+	friend bool operator!=(arena_allocator a, arena_allocator<U> b) noexcept  { return &a.get_arena() != &b.get_arena(); }
+
+private:
+	arena * _arena;
+};
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+inline void * arena::_getChunk(size_t const size)
+{
+	using F = _detail::Malloc<alignof(_chunkHeader)>;
+	return _detail::AllocAndHandleFail<F>(size);
+}
+
+inline void arena::_freeChunk(_chunkHeader *const c) noexcept
+{
+	_detail::Free<alignof(_chunkHeader)>(c, c->size);
+}
+
+inline void * arena::allocate(size_t const bytes, size_t const alignment)
+{
+	return _bump.allocate(bytes, alignment, _getChunk);
+}
+
+inline void * arena::reallocate(void *const p, size_t const oldBytes, size_t const newBytes, size_t const alignment)
+{
+	if( _bump.resizeLast(p, oldBytes, newBytes) )
+	{
+		return p;
+	}
+	else
+	{	auto const newP = allocate(newBytes, alignment);
+		if( p )
+			std::memcpy(newP, p, oldBytes < newBytes ? oldBytes : newBytes);
+		return newP;
+	}
+}
+
+inline void arena::deallocate(void *const p, size_t const bytes) noexcept
+{
+	_bump.deallocate(p, bytes);
+}
+
+inline void arena::reset() noexcept
+{
+	_bump.reset(_freeChunk);
+}
+
+} // namespace oel
@@ -0,0 +1,137 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "../fwd.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace oel::_detail
+{
+	// The bump allocation shared by arena and pmr::monotonic_realloc_resource. Where the chunks come from
+	// is up to the user: getChunk(size) must return size bytes aligned as Header, freeChunk(Header *) takes them back.
+	// The most recent allocation is recognized by ending at cur, so it can be resized in place
+	class BumpChunks
+	{
+	public:
+		struct alignas(std::max_align_t) Header
+		{
+			Header * prev;
+			size_t   size;
+		};
+
+		Header *    chunks{};
+		std::byte * cur{};
+		std::byte * end{};
+		size_t      nextSize;
+
+		explicit BumpChunks(size_t initialChunkBytes) noexcept
+		 :	nextSize{initialChunkBytes} {}
+
+		template< typename GetChunk >
+		std::byte * allocate(size_t const bytes, size_t const alignment, GetChunk getChunk)
+		{
+			auto p = _alignedCur(alignment, bytes);
+			if( !p )
+			{
+				_newChunk(bytes + alignment - 1, getChunk);
+				p = _alignedCur(alignment, bytes);
+			}
+			cur = p + bytes;
+			return p;
+		}
+
+		// Returns false if p is not the most recent allocation, or the chunk has no room
+		bool resizeLast(void *const p, size_t const oldBytes, size_t const newBytes) noexcept
+		{
+			auto const bp = static_cast<std::byte *>(p);
+			if( p and bp + oldBytes == cur and static_cast<size_t>(end - bp) >= newBytes )
+			{
+				cur = bp + newBytes;
+				return true;
+			}
+			return false;
+		}
+
+		// Only reclaims the space if p is the most recent allocation
+		void deallocate(void *const p, size_t const bytes) noexcept
+		{
+			auto const bp = static_cast<std::byte *>(p);
+			if( p and bp + bytes == cur )
+				cur = bp;
+		}
+
+		// Frees the chunks newer than keep, and continues allocating from keepCur, which must be in keep
+		template< typename FreeChunk >
+		void rewind(Header *const keep, std::byte *const keepCur, FreeChunk freeChunk) noexcept
+		{
+			while( chunks != keep )
+			{
+				auto const prev = chunks->prev;
+				freeChunk(chunks);
+				chunks = prev;
+			}
+			cur = keepCur;
+			end = keep ? reinterpret_cast<std::byte *>(keep) + keep->size : nullptr;
+		}
+
+		// Frees all but the newest chunk, and makes all of that available again
+		template< typename FreeChunk >
+		void reset(FreeChunk freeChunk) noexcept
+		{
+			if( auto const newest = chunks )
+			{
+				chunks = newest->prev;
+				rewind(nullptr, nullptr, freeChunk);
+				newest->prev = nullptr;
+				chunks = newest;
+				cur = reinterpret_cast<std::byte *>(newest + 1);
+				end = reinterpret_cast<std::byte *>(newest) + newest->size;
+			}
+		}
+
+		size_t chunkBytes() const noexcept
+		{
+			size_t n{};
+			for( auto c = chunks; c; c = c->prev )
+				n += c->size;
+			return n;
+		}
+
+	private:
+		std::byte * _alignedCur(size_t const alignment, size_t const bytes) const noexcept
+		{
+			OEL_ASSERT((alignment & (alignment - 1)) == 0);
+
+			auto const c = reinterpret_cast<std::uintptr_t>(cur);
+			auto const e = reinterpret_cast<std::uintptr_t>(end);
+			auto const aligned = (c + (alignment - 1)) & ~(alignment - 1);
+			if( cur and aligned <= e and e - aligned >= bytes )
+				return reinterpret_cast<std::byte *>(aligned);
+			else
+				return nullptr;
+		}
+
+		template< typename GetChunk >
+		void _newChunk(size_t const minBytes, GetChunk getChunk)
+		{
+			auto size = nextSize;
+			if( size < sizeof(Header) + minBytes )
+				size = sizeof(Header) + minBytes;
+
+			auto const h = static_cast<Header *>( getChunk(size) );
+			h->prev = chunks;
+			h->size = size;
+			chunks = h;
+			cur = reinterpret_cast<std::byte *>(h + 1);
+			end = reinterpret_cast<std::byte *>(h) + size;
+			nextSize = 2 * size;
+		}
+	};
+}
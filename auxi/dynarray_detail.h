@@ -6,9 +6,12 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 
+#include "../allocator.h" // for allocation_result
 #include "../util.h" // for from_range
 
 #include <cstdint>  // for uintptr_t
+#include <cstring>
+#include <memory>   // for allocator_traits
 #include <stdexcept>
 
 
@@ -47,6 +50,88 @@ namespace oel::_detail
 		return static_cast<DebugAllocationHeader *>(data) - 1;
 	}
 
+	template< typename Alloc >
+	auto AllocateAtLeast(Alloc & a, size_t n)
+	->	decltype( a.allocate_at_least(n) )
+	{	return    a.allocate_at_least(n); }
+
+	template< typename Alloc, typename... None >
+	allocation_result<typename Alloc::value_type *> AllocateAtLeast(Alloc & a, size_t n, None...)
+	{
+		return {a.allocate(n), n};
+	}
+
+	template< typename Alloc, typename = void >
+	inline constexpr bool hasAllocateZeroed = false;
+
+	template< typename Alloc >
+	inline constexpr bool hasAllocateZeroed
+		<	Alloc,
+			std::void_t< decltype( std::declval<Alloc &>().allocate_zeroed(size_t{}) ) >
+		>	= true;
+
+	// For types where zeroIsValueInit only. Falls back to memset if Alloc has no allocate_zeroed
+
+	template< typename Alloc >
+	auto AllocateZeroed(Alloc & a, size_t n)
+	->	decltype( a.allocate_zeroed(n) )
+	{	return    a.allocate_zeroed(n); }
+
+	template< typename Alloc, typename... None >
+	typename Alloc::value_type * AllocateZeroed(Alloc & a, size_t n, None...)
+	{
+		auto const p = std::allocator_traits<Alloc>::allocate(a, n);
+		std::memset(static_cast<void *>(p), 0, sizeof *p * n);
+		return p;
+	}
+
+	// Tells an allocator that wants to know, like stats_allocator, that dynarray changed capacity.
+	// size is what the operation ends with, no matter when during it the capacity changed
+
+	template< typename Alloc >
+	auto OnRelocate(Alloc & a, size_t nRelocated, size_t size, size_t capacity)
+	->	decltype( a.on_relocate(nRelocated, size, capacity) )
+	{	return    a.on_relocate(nRelocated, size, capacity); }
+
+	template< typename Alloc, typename... None >
+	void OnRelocate(Alloc &, size_t, size_t, size_t, None...) {}
+
+	template< int N >
+	struct Rank : Rank<N - 1> {};
+
+	template<>
+	struct Rank<0> {};
+
+	// Calls the most informative reallocate function that Alloc has
+
+	template< typename Alloc, typename Ptr >
+	auto ReallocAtLeast(Alloc & a, Ptr p, size_t oldN, size_t n, Rank<3>)
+	->	decltype( a.reallocate_at_least(p, oldN, n) )
+	{	return    a.reallocate_at_least(p, oldN, n); }
+
+	template< typename Alloc, typename Ptr >
+	auto ReallocAtLeast(Alloc & a, Ptr p, size_t, size_t n, Rank<2>)
+	->	decltype( a.reallocate_at_least(p, n) )
+	{	return    a.reallocate_at_least(p, n); }
+
+	template< typename Alloc, typename Ptr >
+	auto ReallocAtLeast(Alloc & a, Ptr p, size_t oldN, size_t n, Rank<1>)
+	->	decltype( allocation_result<Ptr>{a.reallocate(p, oldN, n), n} )
+	{	return    allocation_result<Ptr>{a.reallocate(p, oldN, n), n}; }
+
+	template< typename Alloc, typename Ptr >
+	allocation_result<Ptr> ReallocAtLeast(Alloc & a, Ptr p, size_t, size_t n, Rank<0>)
+	{
+		return {a.reallocate(p, n), n};
+	}
+
+	template< typename Alloc, typename Ptr >
+	allocation_result<Ptr> ReallocAtLeast(Alloc & a, Ptr p, size_t oldN, size_t n)
+	{
+		return _detail::ReallocAtLeast(a, p, oldN, n, Rank<3>{});
+	}
+
+
 	template< typename Alloc, typename Ptr >
 	struct DebugAllocateWrapper
 	{
@@ -69,30 +154,44 @@ namespace oel::_detail
 		}
 	#endif
 
-		static Ptr allocate(Alloc & a, size_t n)
+		// These return the count that the allocator made available, which can be greater than n
+
+		static allocation_result<Ptr> allocate(Alloc & a, size_t n)
 		{
 		#if OEL_MEM_BOUND_DEBUG_LVL
 			n += sizeForHeader;
-			Ptr p = a.allocate(n);
-			return _addHeader(a, p);
+			auto r = _detail::AllocateAtLeast(a, n);
+			return {_addHeader(a, r.ptr), r.count - sizeForHeader};
 		#else
-			return a.allocate(n);
+			return _detail::AllocateAtLeast(a, n);
 		#endif
 		}
 
-		static Ptr realloc(Alloc & a, Ptr p, size_t n)
+		static allocation_result<Ptr> allocateZeroed(Alloc & a, size_t n)
+		{
+		#if OEL_MEM_BOUND_DEBUG_LVL
+			auto const p = _detail::AllocateZeroed(a, n + sizeForHeader);
+			return {_addHeader(a, p), n};
+		#else
+			return {_detail::AllocateZeroed(a, n), n};
+		#endif
+		}
+
+		// oldN is the capacity of p, which is passed on if the allocator wants it
+		static allocation_result<Ptr> realloc(Alloc & a, Ptr p, size_t oldN, size_t n)
 		{
 		#if OEL_MEM_BOUND_DEBUG_LVL
 			if( p )
 			{	// volatile to make sure the write isn't optimized away
 				static_cast<volatile std::uintptr_t &>(_detail::DebugHeaderOf(p)->id) = 0;
 				p -= sizeForHeader;
+				oldN += sizeForHeader;
 			}
 			n += sizeForHeader;
-			p = a.reallocate(p, n);
-			return _addHeader(a, p);
+			auto r = _detail::ReallocAtLeast(a, p, oldN, n);
+			return {_addHeader(a, r.ptr), r.count - sizeForHeader};
 		#else
-			return a.reallocate(p, n);
+			return _detail::ReallocAtLeast(a, p, oldN, n);
 		#endif
 		}
 
@@ -136,6 +235,9 @@ namespace oel::_detail
 		Ptr reservEnd;
 	};
 
+	template< typename T, typename Alloc, typename Storage >
+	class DynarrLease;
+
 
 
 	template< typename Alloc >
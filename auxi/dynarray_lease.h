@@ -0,0 +1,49 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "../dynarray.h"
+
+
+namespace oel::_detail
+{
+	// Lets a dynarray temporarily operate on memory owned by another container, to reuse all of its growth
+	// and relocation logic. Storage must have member functions load() and store(const DynarrBase<T *> &),
+	// store is called when the lease ends, also if the operation threw
+	template< typename T, typename Alloc, typename Storage >
+	class DynarrLease
+	{
+		using _base = DynarrBase<T *>;
+
+		dynarray<T, Alloc> _d;
+		Storage &          _owner;
+
+	public:
+		DynarrLease(Storage & owner, Alloc a) noexcept
+		 :	_d(std::move(a)), _owner(owner)
+		{
+			_base & b = _d._m;
+			b = owner.load();
+		}
+
+		DynarrLease(const DynarrLease &) = delete;
+
+		~DynarrLease()
+		{
+			_base & b = _d._m;
+			_owner.store(b);
+			b = {};
+		}
+
+		OEL_ALWAYS_INLINE
+		dynarray<T, Alloc> * operator->() noexcept  { return &_d; }
+
+		//! Convert pointer into the leased memory to iterator of the dynarray
+		template< typename Ptr >
+		auto iter(Ptr p) noexcept  { return _detail::MakeDynarrIter(_d._m, p); }
+	};
+}
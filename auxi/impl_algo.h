@@ -79,12 +79,18 @@ namespace oel::_detail
 	#undef OEL_CHECK_NULL_MEMCPY
 
 
+	// True if value-initializing T can be done by setting all bytes to zero. Not so for pointers to
+	// data members, which are -1 when null with the common ABIs (assumed not to be members of classes)
+	template< typename T >
+	inline constexpr bool zeroIsValueInit =
+		std::is_trivially_default_constructible_v<T> and !std::is_member_pointer_v< std::remove_all_extents_t<T> >;
+
 	struct ValueInit
 	{
 		template< typename Alloc, typename T >
 		static void call(T *__restrict first, T *const last, [[maybe_unused]] Alloc a)
 		{
-			if constexpr( std::is_trivially_default_constructible_v<T> )
+			if constexpr( zeroIsValueInit<T> )
 			{
 				void * p{first};  // silence -Wclass-memaccess
 				std::memset(p, 0, sizeof(T) * (last - first));
@@ -127,6 +133,14 @@ namespace oel::_detail
 		iter_is< iterator_t<Range>, std::forward_iterator_tag >
 		or range_is_sized<Range>;
 
+	// Like std::ranges::reserve_hint (C++26), but only uses member reserve_hint. 0 if there is none
+	template< typename Range >
+	auto ReserveHint(Range & r, int)
+	->	decltype( static_cast<size_t>(r.reserve_hint()) ) { return static_cast<size_t>(r.reserve_hint()); }
+
+	template< typename Range >
+	size_t ReserveHint(Range &, long) { return 0; }
+
 	// Used only if rangeIsForwardOrSized
 	template< typename Range >
 	auto UDist(Range & r)
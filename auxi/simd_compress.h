@@ -0,0 +1,315 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "core_util.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+//! @cond INTERNAL
+
+#ifndef OEL_HAS_SIMD_COMPRESS
+	#if defined __GNUC__ and (defined __x86_64__ or defined __i386__)
+	#define OEL_HAS_SIMD_COMPRESS  1
+	#else
+	#define OEL_HAS_SIMD_COMPRESS  0
+	#endif
+#endif
+
+#if OEL_HAS_SIMD_COMPRESS
+#include <immintrin.h>
+#endif
+
+//! @endcond
+
+
+namespace oel::_detail
+{
+	enum class CmpOp { none, lt, le, gt, ge, eq, ne };
+
+	// Compare must be a standard comparison function object with void or T as template argument
+	template< typename T, typename Compare >
+	constexpr CmpOp CmpOpOf()
+	{
+		using C = Compare;
+		if constexpr( std::is_same_v<C, std::less<>> or std::is_same_v<C, std::less<T>> )
+			return CmpOp::lt;
+		else if constexpr( std::is_same_v<C, std::less_equal<>> or std::is_same_v<C, std::less_equal<T>> )
+			return CmpOp::le;
+		else if constexpr( std::is_same_v<C, std::greater<>> or std::is_same_v<C, std::greater<T>> )
+			return CmpOp::gt;
+		else if constexpr( std::is_same_v<C, std::greater_equal<>> or std::is_same_v<C, std::greater_equal<T>> )
+			return CmpOp::ge;
+		else if constexpr( std::is_same_v<C, std::equal_to<>> or std::is_same_v<C, std::equal_to<T>> )
+			return CmpOp::eq;
+		else if constexpr( std::is_same_v<C, std::not_equal_to<>> or std::is_same_v<C, std::not_equal_to<T>> )
+			return CmpOp::ne;
+		else
+			return CmpOp::none;
+	}
+
+	// True if CompressCmp can be used for elements of type T compared to a value of type U
+	template< typename T, typename Compare, typename U >
+	inline constexpr bool canCompressCmp =
+		std::is_arithmetic_v<T> and !std::is_same_v<T, bool> and (sizeof(T) == 4 or sizeof(T) == 8)
+		and std::is_same_v<T, U> and CmpOpOf<T, Compare>() != CmpOp::none;
+
+
+	template< CmpOp Op, typename T >
+	OEL_ALWAYS_INLINE inline bool ScalarCmp(T const x, T const value)
+	{
+		if constexpr( Op == CmpOp::lt )      return x < value;
+		else if constexpr( Op == CmpOp::le ) return x <= value;
+		else if constexpr( Op == CmpOp::gt ) return x > value;
+		else if constexpr( Op == CmpOp::ge ) return x >= value;
+		else if constexpr( Op == CmpOp::eq ) return x == value;
+		else                                 return x != value;
+	}
+
+	// Continues from index i in src and k in dest
+	template< CmpOp Op, typename T >
+	size_t CompressScalar(const T * src, size_t const n, T * dest, T const value, bool const keep, size_t i, size_t k)
+	{
+		for( ; i < n; ++i )
+		{
+			T const x = src[i];
+			dest[k] = x; // unconditional store and conditional increment to avoid branch misprediction
+			k += (ScalarCmp<Op>(x, value) == keep);
+		}
+		return k;
+	}
+
+#if OEL_HAS_SIMD_COMPRESS
+	enum class SimdLevel { none, avx2, avx512 };
+
+	inline SimdLevel SimdSupport() noexcept
+	{
+		static SimdLevel const level =
+			__builtin_cpu_supports("avx512f") ? SimdLevel::avx512 :
+			__builtin_cpu_supports("avx2")    ? SimdLevel::avx2 :
+			                                    SimdLevel::none;
+		return level;
+	}
+
+	template< CmpOp Op >
+	constexpr int FloatCmpImmFn()
+	{
+		if constexpr( Op == CmpOp::lt )      return _CMP_LT_OQ;
+		else if constexpr( Op == CmpOp::le ) return _CMP_LE_OQ;
+		else if constexpr( Op == CmpOp::gt ) return _CMP_GT_OQ;
+		else if constexpr( Op == CmpOp::ge ) return _CMP_GE_OQ;
+		else if constexpr( Op == CmpOp::eq ) return _CMP_EQ_OQ;
+		else                                 return _CMP_NEQ_UQ;
+	}
+
+	template< CmpOp Op >
+	constexpr int IntCmpImmFn()
+	{
+		if constexpr( Op == CmpOp::lt )      return _MM_CMPINT_LT;
+		else if constexpr( Op == CmpOp::le ) return _MM_CMPINT_LE;
+		else if constexpr( Op == CmpOp::gt ) return _MM_CMPINT_NLE;
+		else if constexpr( Op == CmpOp::ge ) return _MM_CMPINT_NLT;
+		else if constexpr( Op == CmpOp::eq ) return _MM_CMPINT_EQ;
+		else                                 return _MM_CMPINT_NE;
+	}
+
+	// Variables rather than function calls, since intrinsics are macros requiring literals with GCC -O0
+	template< CmpOp Op >
+	inline constexpr int floatCmpImm = FloatCmpImmFn<Op>();
+
+	template< CmpOp Op >
+	inline constexpr int intCmpImm = IntCmpImmFn<Op>();
+
+	template< CmpOp Op, typename T >
+	__attribute__((target("avx512f")))
+	size_t CompressAvx512(const T * src, size_t const n, T * dest, T const value, bool const keep)
+	{
+		size_t i{};
+		size_t k{};
+		if constexpr( sizeof(T) == 4 )
+		{
+			unsigned const flip = keep ? 0 : 0xFFFF;
+			for( ; i + 16 <= n; i += 16 )
+			{
+				unsigned m;
+				if constexpr( std::is_floating_point_v<T> )
+				{
+					auto const x = _mm512_loadu_ps(src + i);
+					m = _mm512_cmp_ps_mask(x, _mm512_set1_ps(value), floatCmpImm<Op>) ^ flip;
+					_mm512_mask_compressstoreu_ps(dest + k, static_cast<__mmask16>(m), x);
+				}
+				else
+				{	auto const x = _mm512_loadu_si512(src + i);
+					auto const v = _mm512_set1_epi32(static_cast<int>(value));
+					if constexpr( std::is_signed_v<T> )
+						m = _mm512_cmp_epi32_mask(x, v, intCmpImm<Op>) ^ flip;
+					else
+						m = _mm512_cmp_epu32_mask(x, v, intCmpImm<Op>) ^ flip;
+
+					_mm512_mask_compressstoreu_epi32(dest + k, static_cast<__mmask16>(m), x);
+				}
+				k += static_cast<size_t>(__builtin_popcount(m));
+			}
+		}
+		else
+		{	unsigned const flip = keep ? 0 : 0xFF;
+			for( ; i + 8 <= n; i += 8 )
+			{
+				unsigned m;
+				if constexpr( std::is_floating_point_v<T> )
+				{
+					auto const x = _mm512_loadu_pd(src + i);
+					m = _mm512_cmp_pd_mask(x, _mm512_set1_pd(value), floatCmpImm<Op>) ^ flip;
+					_mm512_mask_compressstoreu_pd(dest + k, static_cast<__mmask8>(m), x);
+				}
+				else
+				{	auto const x = _mm512_loadu_si512(src + i);
+					auto const v = _mm512_set1_epi64(static_cast<long long>(value));
+					if constexpr( std::is_signed_v<T> )
+						m = _mm512_cmp_epi64_mask(x, v, intCmpImm<Op>) ^ flip;
+					else
+						m = _mm512_cmp_epu64_mask(x, v, intCmpImm<Op>) ^ flip;
+
+					_mm512_mask_compressstoreu_epi64(dest + k, static_cast<__mmask8>(m), x);
+				}
+				k += static_cast<size_t>(__builtin_popcount(m));
+			}
+		}
+		return _detail::CompressScalar<Op>(src, n, dest, value, keep, i, k);
+	}
+
+	// For each 8-bit mask, the indices of the set bits packed into bytes, to be used with vpermd
+	constexpr std::array<std::uint64_t, 256> MakeCompressPermuteTable()
+	{
+		std::array<std::uint64_t, 256> table{};
+		for( unsigned m{}; m < 256; ++m )
+		{
+			std::uint64_t packed{};
+			unsigned pos{};
+			for( unsigned bit{}; bit < 8; ++bit )
+			{
+				if( m & (1u << bit) )
+					packed |= std::uint64_t{bit} << (8 * pos++);
+			}
+			table[m] = packed;
+		}
+		return table;
+	}
+
+	inline constexpr auto compressPermuteTable = _detail::MakeCompressPermuteTable();
+
+	// Bit i is set if lane i of the comparison is true. Lanes are 32 or 64 bit, as sizeof(T)
+	template< CmpOp Op, typename T >
+	__attribute__((target("avx2")))
+	unsigned CmpMaskAvx2(__m256i const x, T const value)
+	{
+		if constexpr( std::is_floating_point_v<T> )
+		{
+			if constexpr( sizeof(T) == 4 )
+				return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_set1_ps(value), floatCmpImm<Op>));
+			else
+				return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_set1_pd(value), floatCmpImm<Op>));
+		}
+		else
+		{	__m256i a;
+			__m256i v;
+			if constexpr( sizeof(T) == 4 )
+			{
+				a = x;
+				v = _mm256_set1_epi32(static_cast<int>(value));
+				if constexpr( std::is_unsigned_v<T> )
+				{	// Flip the sign bit to compare unsigned with signed instructions
+					auto const bias = _mm256_set1_epi32(INT32_MIN);
+					a = _mm256_xor_si256(a, bias);
+					v = _mm256_xor_si256(v, bias);
+				}
+			}
+			else
+			{	a = x;
+				v = _mm256_set1_epi64x(static_cast<long long>(value));
+				if constexpr( std::is_unsigned_v<T> )
+				{
+					auto const bias = _mm256_set1_epi64x(INT64_MIN);
+					a = _mm256_xor_si256(a, bias);
+					v = _mm256_xor_si256(v, bias);
+				}
+			}
+			__m256i r;
+			if constexpr( sizeof(T) == 4 )
+			{
+				if constexpr( Op == CmpOp::lt or Op == CmpOp::ge )
+					r = _mm256_cmpgt_epi32(v, a);
+				else if constexpr( Op == CmpOp::gt or Op == CmpOp::le )
+					r = _mm256_cmpgt_epi32(a, v);
+				else
+					r = _mm256_cmpeq_epi32(a, v);
+			}
+			else
+			{	if constexpr( Op == CmpOp::lt or Op == CmpOp::ge )
+					r = _mm256_cmpgt_epi64(v, a);
+				else if constexpr( Op == CmpOp::gt or Op == CmpOp::le )
+					r = _mm256_cmpgt_epi64(a, v);
+				else
+					r = _mm256_cmpeq_epi64(a, v);
+			}
+			unsigned m = (sizeof(T) == 4) ?
+				_mm256_movemask_ps(_mm256_castsi256_ps(r)) :
+				_mm256_movemask_pd(_mm256_castsi256_pd(r));
+			// Negate for le, ge, ne
+			if constexpr( Op == CmpOp::le or Op == CmpOp::ge or Op == CmpOp::ne )
+				m ^= (sizeof(T) == 4) ? 0xFF : 0xF;
+
+			return m;
+		}
+	}
+
+	template< CmpOp Op, typename T >
+	__attribute__((target("avx2")))
+	size_t CompressAvx2(const T * src, size_t const n, T * dest, T const value, bool const keep)
+	{
+		constexpr size_t lanes = 32 / sizeof(T);
+		unsigned const flip = keep ? 0 : (1u << lanes) - 1;
+
+		size_t i{};
+		size_t k{};
+		for( ; i + lanes <= n; i += lanes )
+		{
+			auto const x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+			unsigned m = _detail::CmpMaskAvx2<Op>(x, value) ^ flip;
+			auto const count = static_cast<size_t>(__builtin_popcount(m));
+			if constexpr( sizeof(T) == 8 )
+			{	// Each 64-bit lane is two 32-bit lanes for the permutation
+				m = ((m & 1) * 3) | ((m & 2) * 6) | ((m & 4) * 12) | ((m & 8) * 24);
+			}
+			auto const idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+				reinterpret_cast<const __m128i *>(&compressPermuteTable[m]) ));
+			// Writes all lanes, which is fine because dest + k + lanes <= dest + i + lanes
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + k), _mm256_permutevar8x32_epi32(x, idx));
+			k += count;
+		}
+		return _detail::CompressScalar<Op>(src, n, dest, value, keep, i, k);
+	}
+#endif
+
+	// Writes each element x of [src, src + n) for which `(x Op value) == keep` to dest, returning the number written.
+	// dest can be equal to src. All of [dest, dest + n) can get written, even if fewer elements are kept
+	template< CmpOp Op, typename T >
+	size_t CompressCmp(const T * src, size_t const n, T * dest, T const value, bool const keep)
+	{
+	#if OEL_HAS_SIMD_COMPRESS
+		switch( _detail::SimdSupport() )
+		{
+		case SimdLevel::avx512: return _detail::CompressAvx512<Op>(src, n, dest, value, keep);
+		case SimdLevel::avx2:   return _detail::CompressAvx2<Op>(src, n, dest, value, keep);
+		case SimdLevel::none:   break;
+		}
+	#endif
+		return _detail::CompressScalar<Op>(src, n, dest, value, keep, 0, 0);
+	}
+}
@@ -0,0 +1,428 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "auxi/dynarray_lease.h"
+
+/** @file
+*/
+
+namespace oel
+{
+namespace _detail
+{
+	// Wraps a growth policy so that capacity never exceeds Max
+	template< typename Policy, size_t Max >
+	struct ClampedGrowth
+	{
+		static constexpr size_t grow(size_t capacity, size_t minCapacity, size_t elemSize)
+		{
+			if( minCapacity > Max )
+				LengthError::raise();
+
+			auto const c = Policy::grow(capacity, minCapacity, elemSize);
+			return c < Max ? c : Max;
+		}
+
+		static constexpr size_t grow_one(size_t capacity, size_t elemSize)
+		{
+			if( capacity >= Max )
+				LengthError::raise();
+
+			auto const c = Policy::grow_one(capacity, elemSize);
+			return c < Max ? c : Max;
+		}
+	};
+
+	// Used by compact_dynarray. Limits the count of an allocation to what fits in uint32_t
+	template< typename T, typename Alloc >
+	struct CompactAlloc
+	{
+		using value_type = T;
+
+		static constexpr size_t maxCount = UINT32_MAX;
+
+		using growth_policy = ClampedGrowth< decltype(_detail::GrowthPolicy<Alloc>(0)),
+		                                     maxCount - DebugAllocateWrapper<Alloc, T *>::sizeForHeader >;
+
+		Alloc innerAlloc;
+
+		static constexpr bool can_reallocate() noexcept  { return allocator_can_realloc<Alloc>(); }
+
+		size_t max_size() const noexcept
+		{
+			auto const n = std::allocator_traits<Alloc>::max_size(innerAlloc);
+			return n < maxCount ? n : maxCount;
+		}
+
+		T * allocate(size_t n)   { return std::allocator_traits<Alloc>::allocate(innerAlloc, n); }
+
+		allocation_result<T *> allocate_at_least(size_t n)
+		{
+			return _clamp(_detail::AllocateAtLeast(innerAlloc, n));
+		}
+
+		template< typename A = Alloc >
+		auto allocate_zeroed(size_t n)
+		->	decltype( std::declval<A &>().allocate_zeroed(n) )
+		{	return    innerAlloc.allocate_zeroed(n); }
+
+		allocation_result<T *> reallocate_at_least(T * p, size_t oldN, size_t n)
+		{
+			return _clamp(_detail::ReallocAtLeast(innerAlloc, p, oldN, n));
+		}
+
+		void deallocate(T * p, size_t n) noexcept
+		{
+			std::allocator_traits<Alloc>::deallocate(innerAlloc, p, n);
+		}
+
+		template< typename U, typename... Args >
+		void construct(U * p, Args &&... args)
+		{
+			std::allocator_traits<Alloc>::construct(innerAlloc, p, static_cast<Args &&>(args)...);
+		}
+
+		friend bool operator==(const CompactAlloc & x, const CompactAlloc & y)  { return x.innerAlloc == y.innerAlloc; }
+		friend bool operator!=(const CompactAlloc & x, const CompactAlloc & y)  { return x.innerAlloc != y.innerAlloc; }
+
+		// Any count between the requested and the one returned by allocate_at_least is fine for deallocate
+		static allocation_result<T *> _clamp(allocation_result<T *> r) noexcept
+		{
+			if( r.count > maxCount )
+				r.count = maxCount;
+			return r;
+		}
+	};
+}
+
+
+//! Resizable array with 32-bit size and capacity, so that it takes two pointers of space instead of three
+/**
+* Has the same interface as dynarray, and shares its implementation of growth, relocation, insert and append.
+* Only differences are documented. Intended for when very many arrays are stored, and none can be large.
+*
+* max_size() is at most UINT32_MAX, growing beyond throws std::length_error.
+* Iterators are plain pointers, even when OEL_MEM_BOUND_DEBUG_LVL is non-zero. */
+template< typename T, typename Alloc = allocator<> >
+class compact_dynarray
+{
+	using _alloTrait = typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+public:
+	using value_type      = T;
+	using allocator_type  = typename _alloTrait::allocator_type;
+	using difference_type = ptrdiff_t;
+	using size_type       = size_t;
+
+	using iterator       = T *;
+	using const_iterator = const T *;
+
+	compact_dynarray() noexcept(noexcept( Alloc{} ))  : compact_dynarray(Alloc{}) {}
+	explicit compact_dynarray(Alloc a) noexcept       : _m(a) {}
+
+	//! Construct empty compact_dynarray with space reserved for at least capacity elements
+	compact_dynarray(reserve_tag, size_type capacity, Alloc a = Alloc{})   : _m(a) { reserve(capacity); }
+
+	//! @copydoc dynarray::dynarray(size_type, for_overwrite_t, Alloc)
+	compact_dynarray(size_type size, for_overwrite_t, Alloc a = Alloc{})   : _m(a) { resize_for_overwrite(size); }
+	//! (Value-initializes elements, same as std::vector)
+	explicit compact_dynarray(size_type size, Alloc a = Alloc{})           : _m(a) { resize(size); }
+
+	template< typename InputRange >
+	compact_dynarray(from_range_t, InputRange && r, Alloc a = Alloc{})   : _m(a) { append_range(r); }
+
+	compact_dynarray(std::initializer_list<T> il, Alloc a = Alloc{})     : _m(a) { append_range(il); }
+
+	compact_dynarray(compact_dynarray && other) noexcept
+	 :	_m(static_cast<allocator_type &>(other._m))
+	{
+		_m.store(other._m.load());
+		other._m.store({});
+	}
+	explicit compact_dynarray(const compact_dynarray & other)
+	 :	_m( _alloTrait::select_on_container_copy_construction(other._m) ) { append_range(other); }
+
+	~compact_dynarray()
+	{
+		_detail::Destroy(data(), end());
+		_free();
+	}
+
+	compact_dynarray & operator =(compact_dynarray && other) &
+		noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value );
+	compact_dynarray & operator =(const compact_dynarray & other) &
+		{
+			if( this != &other )
+				assign_range(other);
+
+			return *this;
+		}
+	compact_dynarray & operator =(const compact_dynarray &&) = delete;
+
+	compact_dynarray & operator =(std::initializer_list<T> il) &  { assign_range(il);  return *this; }
+
+	friend void swap(compact_dynarray & a, compact_dynarray & b) noexcept
+		{
+			auto const tmp = a._m.load();
+			a._m.store(b._m.load());
+			b._m.store(tmp);
+
+			[[maybe_unused]] allocator_type & a0 = a._m;
+			[[maybe_unused]] allocator_type & a1 = b._m;
+			if constexpr( _alloTrait::propagate_on_container_swap::value )
+			{
+				using std::swap;
+				swap(a0, a1);
+			}
+			else
+			{	OEL_ASSERT(a0 == a1);
+			}
+		}
+
+	template< typename InputRange >
+	void assign_range(InputRange && source)   { _lease()->assign_range(source); }
+
+	template< typename InputRange = std::initializer_list<T> >
+	void append_range(InputRange && source)   { _lease()->append_range(source); }
+
+	void resize_for_overwrite(size_type n)    { _lease()->resize_for_overwrite(n); }
+	void resize(size_type n)                  { _lease()->resize(n); }
+
+	template< typename Range >
+	iterator insert_range(const_iterator pos, Range && source) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->insert_range(l.iter(pos), source) );
+		}
+
+	iterator insert(const_iterator pos, T && val) &       { return emplace(pos, std::move(val)); }
+	iterator insert(const_iterator pos, const T & val) &  { return emplace(pos, val); }
+
+	template< typename... Args >
+	iterator emplace(const_iterator pos, Args &&... args) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->emplace(l.iter(pos), static_cast<Args &&>(args)...) );
+		}
+
+	template< typename... Args >
+	T &  emplace_back(Args &&... args) &
+		{
+			if( _m.size < _m.capacity )
+			{	// Skipping the lease for the common case
+				T *const p = _m.data + _m.size;
+				_alloTrait::construct(_m, p, static_cast<Args &&>(args)...);
+				++_m.size;
+				_debugSizeUpdate();
+				return *p;
+			}
+			return _lease()->emplace_back(static_cast<Args &&>(args)...);
+		}
+
+	void push_back(T && val)       { emplace_back(std::move(val)); }
+	void push_back(const T & val)  { emplace_back(val); }
+
+	void pop_back() noexcept
+		{
+			OEL_ASSERT(_m.size > 0);
+			--_m.size;
+			_m.data[_m.size].~T();
+			_debugSizeUpdate();
+		}
+
+	void     unordered_erase(iterator pos)
+		{
+			auto l = _lease();
+			l->unordered_erase(l.iter(pos));
+		}
+
+	iterator erase(const_iterator pos) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(pos)) );
+		}
+
+	iterator erase(const_iterator first, const_iterator last) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(first), l.iter(last)) );
+		}
+
+	void     erase_to_end(const_iterator first) noexcept
+		{
+			auto const newEnd = const_cast<T *>(first);
+			OEL_ASSERT(data() <= newEnd and newEnd <= end());
+
+			_detail::Destroy(newEnd, end());
+			_m.size = static_cast<std::uint32_t>(newEnd - _m.data);
+			_debugSizeUpdate();
+		}
+
+	void     clear() noexcept   { erase_to_end(_m.data); }
+
+	void     reserve(size_type minCap)
+		{
+			if( capacity() < minCap )
+				_lease()->reserve(minCap);
+		}
+
+	void     shrink_to_fit()   { _lease()->shrink_to_fit(); }
+
+	[[nodiscard]] bool empty() const noexcept  { return _m.size == 0; }
+
+	size_type size() const noexcept            { return _m.size; }
+
+	size_type capacity() const noexcept        { return _m.capacity; }
+
+	size_type max_size() const noexcept   { return _leaseAlloc{_m}.max_size() - _allocateWrap::sizeForHeader; }
+
+	allocator_type get_allocator() const noexcept   { return _m; }
+
+	iterator       begin() noexcept          { return _m.data; }
+	const_iterator begin() const noexcept    { return _m.data; }
+	const_iterator cbegin() const noexcept   { return _m.data; }
+
+	iterator       end() noexcept          { return _m.data + _m.size; }
+	const_iterator end() const noexcept    { return _m.data + _m.size; }
+	const_iterator cend() const noexcept   { return _m.data + _m.size; }
+
+	auto      rbegin() noexcept         { return std::reverse_iterator{end()}; }
+	auto      rbegin() const noexcept   { return std::reverse_iterator{end()}; }
+	auto      crbegin() const noexcept  { return std::reverse_iterator{end()}; }
+
+	auto      rend() noexcept         { return std::reverse_iterator{begin()}; }
+	auto      rend() const noexcept   { return std::reverse_iterator{begin()}; }
+	auto      crend() const noexcept  { return std::reverse_iterator{begin()}; }
+
+	T *       data() noexcept         { return _m.data; }
+	const T * data() const noexcept   { return _m.data; }
+
+	T &       front() noexcept        { return (*this)[0]; }
+	const T & front() const noexcept  { return (*this)[0]; }
+
+	T &       back() noexcept         { return (*this)[size() - 1]; }
+	const T & back() const noexcept   { return (*this)[size() - 1]; }
+
+	T &       operator[](size_type index) noexcept        { OEL_ASSERT(index < size());  return _m.data[index]; }
+	const T & operator[](size_type index) const noexcept  { OEL_ASSERT(index < size());  return _m.data[index]; }
+
+	OEL_ALWAYS_INLINE
+	T &       at(size_type index)
+		{
+			const auto & cSelf = *this;
+			return const_cast<T &>(cSelf.at(index));
+		}
+	const T & at(size_type index) const
+		{
+			if( index < size() )
+				return _m.data[index];
+			else
+				_detail::OutOfRange::raise();
+		}
+
+	friend bool operator==(const compact_dynarray & left, const compact_dynarray & right)
+		{
+			return left.size() == right.size() and
+			       std::equal(left.begin(), left.end(), right.begin());
+		}
+	friend bool operator!=(const compact_dynarray & left, const compact_dynarray & right)  { return !(left == right); }
+
+	friend bool operator <(const compact_dynarray & left, const compact_dynarray & right)
+		{
+			return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+		}
+	friend bool operator >(const compact_dynarray & left, const compact_dynarray & right)  { return right < left; }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	using _allocateWrap = _detail::DebugAllocateWrapper<allocator_type, T *>;
+	using _usedAlloc_7KQw = allocator_type; // guarding against name collision due to inheritance (MSVC)
+
+	using _leaseAlloc = _detail::CompactAlloc<T, allocator_type>;
+
+	struct _storage : public _usedAlloc_7KQw
+	{
+		using B = ::oel::_detail::DynarrBase<value_type *>;
+
+		value_type *  data{};
+		std::uint32_t size{};
+		std::uint32_t capacity{};
+
+		_storage(_usedAlloc_7KQw a) noexcept
+		 :	_usedAlloc_7KQw(std::move(a))
+		{}
+
+		B    load() const noexcept  { return {data, data + size, data + capacity}; }
+
+		void store(const B & b) noexcept
+		{	// CompactAlloc makes sure that these fit
+			data     = b.data;
+			size     = static_cast<std::uint32_t>(b.end - b.data);
+			capacity = static_cast<std::uint32_t>(b.reservEnd - b.data);
+		}
+	}
+	_m;
+
+
+	auto _lease() noexcept
+	{
+		allocator_type & a = _m;
+		return _detail::DynarrLease<T, _leaseAlloc, _storage>(_m, _leaseAlloc{a});
+	}
+
+	// Needed where the lease is skipped, since the dynarray of a lease checks iterators against the header
+	void _debugSizeUpdate() noexcept
+	{
+	#if OEL_MEM_BOUND_DEBUG_LVL
+		if( _m.data )
+			_detail::DebugHeaderOf(_m.data)->nObjects = _m.size;
+	#endif
+	}
+
+	void _free() noexcept
+	{
+		if( _m.data )
+			_allocateWrap::dealloc(_m, _m.data, capacity());
+	}
+};
+
+//! compact_dynarray is trivially relocatable if Alloc is
+template< typename T, typename Alloc >
+is_trivially_relocatable<Alloc> specify_trivial_relocate(compact_dynarray<T, Alloc>);
+
+
+template< typename T, typename Alloc >
+compact_dynarray<T, Alloc> &
+	compact_dynarray<T, Alloc>::operator =(compact_dynarray && other) &
+	noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value )
+{
+	[[maybe_unused]] allocator_type & myA = _m;
+	if constexpr( !(_alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value) )
+	    if( myA != other._m )
+		{
+			assign_range(other | view::move);
+			return *this;
+		}
+
+	_detail::Destroy(data(), end());
+	_free();
+	if constexpr( _alloTrait::propagate_on_container_move_assignment::value )
+		myA = static_cast<allocator_type &&>(other._m);
+
+	_m.store(other._m.load());
+	other._m.store({});
+	return *this;
+}
+
+} // namespace oel
@@ -7,6 +7,7 @@
 
 
 #include "allocator.h"
+#include "growth_policy.h"
 #include "auxi/dynarray_iterator.h"
 #include "auxi/impl_algo.h"
 #include "optimize_ext/default.h"
@@ -38,6 +39,18 @@ template< typename T, typename Alloc >
 is_trivially_relocatable<Alloc> specify_trivial_relocate(dynarray<T, Alloc>);
 
 
+//! Memory block with elements, handed between dynarray and code that owns it, see dynarray::adopt and release
+/**
+* [data, data + size) are alive objects, and capacity is the count that the block must be deallocated with */
+template< typename T >
+struct dynarray_buffer
+{
+	T *    data;
+	size_t size;
+	size_t capacity;
+};
+
+
 #if OEL_MEM_BOUND_DEBUG_LVL
 inline namespace debug
 {
@@ -56,6 +69,7 @@ inline namespace debug
 * Note that the allocator model is not quite standard: `destroy` is never used, `construct` may not be called
 * if T is trivially constructible and is not called when relocating elements. Also, Alloc::value_type need not
 * be the same as T, it will be rebound, so you can use e.g. `std::pmr::polymorphic_allocator<>`.
+* The allocator can also select how capacity grows, see growth_policy.h
 *
 * For any function which takes a range, `end(range)` is not needed if `range.size()` is valid.
 */
@@ -81,7 +95,9 @@ public:
 	constexpr dynarray() noexcept(noexcept( Alloc{} ))  : dynarray(Alloc{}) {}
 	constexpr explicit dynarray(Alloc a) noexcept       : _m(a) {}
 
-	//! Construct empty dynarray with space reserved for exactly capacity elements
+	//! Construct empty dynarray with space reserved for at least capacity elements
+	/**
+	* Capacity is exactly as requested unless allocator_type has `allocate_at_least`, like oel::allocator */
 	dynarray(reserve_tag, size_type capacity, Alloc a = Alloc{})   : _m(a) { _initReserve(capacity); }
 
 	//! Default-initializes elements, can be significantly faster if T is scalar or has trivial default constructor
@@ -89,6 +105,7 @@ public:
 	* @copydetails resize_for_overwrite(size_type)  */
 	dynarray(size_type size, for_overwrite_t, Alloc a = Alloc{});
 	//! (Value-initializes elements, same as std::vector)
+	/** If T is trivially default constructible, memory is from `Alloc::allocate_zeroed` when available */
 	explicit dynarray(size_type size, Alloc a = Alloc{});
 
 	template< typename InputRange >
@@ -126,6 +143,10 @@ public:
 				OEL_ASSERT(a0 == a1);
 		}
 
+	//! Replace the elements with those of source
+	/** @pre `source` shall not refer to any elements in this dynarray if `capacity()` is less than the number
+	*	of source elements. The old memory is then freed before allocating, and if allocation throws, the
+	*	dynarray is left empty */
 	template< typename InputRange >
 	void assign_range(InputRange && source);
 
@@ -133,22 +154,56 @@ public:
 	/** @pre `source` shall not refer to any elements in this dynarray if reallocation happens.
 	*	Reallocation is caused by `capacity() - size() < n`, where `n` is number of source elements
 	*
+	* If source is neither forward nor sized, but has member `reserve_hint()` (like C++26 ranges), space for
+	* that many more elements is reserved first.
+	*
 	* If an exception is thrown, the dynarray will keep all elements already appended during the operation. */
 	template< typename InputRange = std::initializer_list<T> >
 	void append_range(InputRange && source);
 
+	//! Relocates all elements of other to the end of this, leaving other empty
+	/**
+	* If this is empty and the allocators are equal, the block of other is taken over, else the elements are
+	* relocated without calling move constructors if T is trivially relocatable. Strong exception guarantee. */
+	void append(dynarray && other);
+
 	//! Default-initializes added elements, can be significantly faster if T is scalar or trivially constructible
 	/**
 	* Objects of scalar type get indeterminate values. http://en.cppreference.com/w/cpp/language/default_initialization  */
 	void resize_for_overwrite(size_type n)   { _doResize<_detail::DefaultInit>(n); }
+	//! Value-initializes added elements
+	/** If T is trivially default constructible, growing an empty dynarray uses `Alloc::allocate_zeroed` when
+	* available, as does growing any if Alloc cannot reallocate  */
 	void resize(size_type n)                 { _doResize<_detail::ValueInit>(n); }
 
+	//! Lets op write up to maxCount new elements at the end, then keeps as many as op returns
+	/**
+	* Like std::string::resize_and_overwrite (C++23), but appending. Called as `op(first, maxCount)`, where
+	* first is a pointer to the maxCount default-initialized elements after the old end, and op must return a
+	* count not greater than maxCount. Replaces resize_for_overwrite followed by erase_to_end when a producer,
+	* like a read from file or a decoder, does not know beforehand how many elements it will write.
+	*
+	* If op throws, the added elements are destroyed and the size is unchanged. */
+	template< typename Operation >
+	void append_and_overwrite(size_type maxCount, Operation op);
+
 	//! Almost same as std::vector::insert_range
 	/**
 	* Requires that source models std::ranges::forward_range or that `source.size()` is valid,
 	* in addition to that T is trivially relocatable. */
 	template< typename Range >
 	iterator insert_range(const_iterator pos, Range && source) &;
+	//! Insert multiple ranges, each before an index of the elements as they were before the call
+	/**
+	* inserts is a bidirectional range of pairs (or tuples), where `std::get<0>` is the index and `std::get<1>` the
+	* range to insert. They must be sorted by index in ascending order, and equal indices keep their order.
+	* Capacity grows at most once, and each element after the first index is relocated only once, so this is
+	* linear in size() plus the number of inserted elements, unlike calling insert_range repeatedly.
+	*
+	* Requires trivially relocatable T, and that each range models std::ranges::forward_range or is sized.
+	* Strong exception guarantee, except that capacity can have grown. */
+	template< typename IndexRangePairs >
+	void insert_ranges(const IndexRangePairs & inserts);
 
 	iterator insert(const_iterator pos, T && val) &       { return emplace(pos, std::move(val)); }
 	iterator insert(const_iterator pos, const T & val) &  { return emplace(pos, val); }
@@ -156,6 +211,13 @@ public:
 	template< typename... Args >
 	iterator emplace(const_iterator pos, Args &&... args) &;
 
+	//! Relocates [first, last) of other to before pos in this, like std::list::splice
+	/**
+	* Requires that T is trivially relocatable, then the elements are moved with one memcpy, and the gaps are
+	* closed with memmove. Elements of other after last are shifted down. @pre `&other != this`
+	* @return iterator to the first relocated element in this */
+	iterator splice(const_iterator pos, dynarray & other, const_iterator first, const_iterator last) &;
+
 	//! Beware, passing an element of same dynarray is often unsafe (otherwise same as std::vector::emplace_back)
 	/** @pre `args` shall not refer to any element of this container, unless `size() < capacity()` */
 	template< typename... Args >
@@ -180,6 +242,20 @@ public:
 	* The iterator pos remains valid, same as if it was returned by `erase`.
 	* Constant complexity (compared to linear in the distance between pos and `end()` for normal erase). */
 	void     unordered_erase(iterator pos);
+	//! Erase the elements at all the indices without maintaining order, in a single pass
+	/**
+	* Starting with the smallest index, each hole is filled with the last element that is kept, then the end
+	* is destroyed at once. Linear in the number of indices. @pre indices is sorted in ascending order, and
+	* each is less than size(). Duplicates are allowed. Requires that indices is a bidirectional range. */
+	template< typename SortedIndexRange >
+	void     unordered_erase_indices(const SortedIndexRange & indices);
+	//! Erase the elements at all the indices, maintaining the order of the rest, in a single pass
+	/**
+	* Linear in size() minus the smallest index, unlike calling erase for each index, which is quadratic.
+	* With trivially relocatable T, each run of elements between two indices is moved with one memmove.
+	* @pre indices is sorted in ascending order with no duplicates, and each is less than size() */
+	template< typename SortedIndexRange >
+	void     erase_indices(const SortedIndexRange & indices);
 
 	iterator erase(const_iterator pos) &;
 
@@ -189,10 +265,24 @@ public:
 
 	void     clear() noexcept   { erase_to_end(begin()); }
 
+	//! Erase all elements for which p returns true, same as std::list::remove_if (C++20)
+	/**
+	* Used by oel::erase_if. With trivially relocatable T, removed elements are destroyed and each run of
+	* kept elements is moved down with one memmove, so move assignment is not needed.
+	* @return the number of elements erased */
+	template< typename UnaryPredicate >
+	size_type remove_if(UnaryPredicate p);
+	//! Erase consecutive duplicate elements, same as std::list::unique (C++20). Used by oel::erase_adjacent_dup
+	/** Works like remove_if, and `==` is used to compare with the previous element that was kept */
+	size_type unique();
+
 	void     reserve(size_type minCap)
 		{
 			if( capacity() < minCap )
-				_realloc(_calcCapChecked(minCap), size());
+			{
+				auto const nRelocated = _realloc(_calcCapChecked(minCap), size());
+				_detail::OnRelocate(_m, nRelocated, size(), capacity());
+			}
 		}
 	//! It's probably a good idea to check that size < capacity before calling, maybe add some treshold to size
 	void      shrink_to_fit();
@@ -208,6 +298,20 @@ public:
 	//! How much smaller capacity is than the number passed to allocator_type::allocate
 	static constexpr size_type allocate_size_overhead() noexcept   { return _allocateWrap::sizeForHeader; }
 
+	//! Take ownership of the block in b, after destroying the elements and freeing the memory of this
+	/**
+	* @pre b.data was allocated with a count of b.capacity by an allocator equal to get_allocator(), or is null
+	*	with zero size and capacity. For oel::allocator, a block from malloc is fine unless T is over-aligned.
+	*
+	* Does not copy, except with OEL_MEM_BOUND_DEBUG_LVL, where the elements are relocated to a new block
+	* with header and b.data is deallocated. If that throws, b is still owned by the caller. */
+	void adopt(dynarray_buffer<T> b);
+	//! Give up ownership of the block, leaving this empty with no capacity
+	/**
+	* The caller must destroy the elements and deallocate data with a count of capacity, using an allocator
+	* equal to get_allocator(). Like adopt, a new block is made with OEL_MEM_BOUND_DEBUG_LVL. */
+	[[nodiscard]] dynarray_buffer<T> release();
+
 	allocator_type get_allocator() const noexcept   { return _m; }
 
 	iterator       begin() noexcept          { return _detail::MakeDynarrIter           (_m, _m.data); }
@@ -276,8 +380,12 @@ public:
 
 
 private:
+	template< typename, typename, typename >
+	friend class _detail::DynarrLease;
+
 	using _allocateWrap = _detail::DebugAllocateWrapper<allocator_type, T *>;
 	using _internBase   = _detail::DynarrBase<T *>;
+	using _growth       = decltype( _detail::GrowthPolicy<allocator_type>(0) );
 	using _debugSizeUpdater = _detail::DebugSizeInHeaderUpdater<_internBase>;
 	using _argAlloc_7KQw  = Alloc; // guarding against name collision due to inheritance (MSVC)
 	using _usedAlloc_7KQw = allocator_type;
@@ -324,8 +432,17 @@ private:
 
 	void _initReserve(size_type const capToCheck)
 	{
-		_m.end = _m.data = _allocateChecked(capToCheck);
-		_m.reservEnd = _m.data + capToCheck;
+		auto const r = _allocateChecked(capToCheck);
+		_m.end = _m.data = r.ptr;
+		_m.reservEnd = r.ptr + r.count;
+	}
+
+	allocation_result<T *> _allocateZeroedChecked(size_type const n)
+	{
+		if( n <= max_size() )
+			return _allocateWrap::allocateZeroed(_m, n);
+		else
+			_detail::LengthError::raise();
 	}
 
 	void _moveInternBase(_internBase & src) noexcept
@@ -343,7 +460,7 @@ private:
 
 	size_type _calcCapUnchecked(size_type const newSize) const
 	{
-		return std::max(2 * capacity(), newSize);
+		return _growth::grow(capacity(), newSize, sizeof(T));
 	}
 
 	size_type _calcCapChecked(size_type const newSize) const
@@ -364,13 +481,10 @@ private:
 
 	size_type _calcCapAddOne() const
 	{
-		constexpr auto startBytesGood = std::max(3 * sizeof(void *), 4 * sizeof(int));
-		constexpr auto minGrow = (startBytesGood + sizeof(T) - 1) / sizeof(T);
-		auto const c = capacity();
-		return c + std::max(c, minGrow); // growth factor is 2
+		return _growth::grow_one(capacity(), sizeof(T));
 	}
 
-	T * _allocateChecked(size_type const n)
+	allocation_result<T *> _allocateChecked(size_type const n)
 	{
 		if( n <= max_size() )
 			return _allocateWrap::allocate(_m, n);
@@ -379,35 +493,63 @@ private:
 	}
 
 
-	void _realloc(size_type const newCap, size_type const oldSize)
+	// Returns the number of elements moved. Leaves calling OnRelocate to the operation, with the size it ends with
+	size_type _realloc(size_type const newCap, size_type const oldSize)
 	{
+		size_type nRelocated = oldSize;
 		if constexpr( oel::allocator_can_realloc<allocator_type>() )
 		{
-			auto const p = _allocateWrap::realloc(_m, _m.data, newCap);
-			_m.data = p;
-			_m.end = p + oldSize;
-			_m.reservEnd = p + newCap;
+			auto const r = _allocateWrap::realloc(_m, _m.data, capacity(), newCap);
+			if( r.ptr == _m.data )
+				nRelocated = 0;
+
+			_m.data = r.ptr;
+			_m.end = r.ptr + oldSize;
+			_m.reservEnd = r.ptr + r.count;
 		}
 		else
-		{	auto const newData = _allocateWrap::allocate(_m, newCap);
-			_m.end = _detail::Relocate(_m.data, oldSize, newData);
-			_resetData(newData, newCap);
+		{	auto const r = _allocateWrap::allocate(_m, newCap);
+			_m.end = _detail::Relocate(_m.data, oldSize, r.ptr);
+			_resetData(r.ptr, r.count);
 		}
 		(void) _debugSizeUpdater{_m};
+		return nRelocated;
 	}
 
+	// For emplace_back, which ends with one more element
 	void _growByOne()
 	{
-		_realloc(_calcCapAddOne(), size());
+		auto const s = size();
+		auto const nRelocated = _realloc(_calcCapAddOne(), s);
+		_detail::OnRelocate(_m, nRelocated, s + 1, capacity());
 	}
-	// Not defined inline as a compiler hint
-	void _growBy(size_type);
+	// For operations that end with count more elements. Not defined inline as a compiler hint
+	void _growBy(size_type count);
 
 
 	template< typename UninitFiller >
 	void _doResize(size_type const newSize)
 	{
-		reserve(newSize);
+		if constexpr( std::is_same_v<UninitFiller, _detail::ValueInit> and _detail::zeroIsValueInit<T>
+		              and _detail::hasAllocateZeroed<allocator_type> )
+		{	// A zeroed block instead of memset, so that only the old elements get written. Not when
+			// realloc is possible, as that usually grows in place, without copying the old elements
+			if( capacity() < newSize and (!_m.data or !oel::allocator_can_realloc<allocator_type>()) )
+			{
+				auto const oldSize = size();
+				auto const r = _allocateZeroedChecked(_calcCapChecked(newSize));
+				_detail::Relocate(_m.data, oldSize, r.ptr);
+				_resetData(r.ptr, r.count);
+				_m.end = r.ptr + newSize;
+				(void) _debugSizeUpdater{_m};
+				_detail::OnRelocate(_m, oldSize, newSize, capacity());
+				return;
+			}
+		}
+		bool const grow = capacity() < newSize;
+		size_type nRelocated{};
+		if( grow )
+			nRelocated = _realloc(_calcCapChecked(newSize), size());
 
 		T *const newEnd = _m.data + newSize;
 		if( _m.end < newEnd )
@@ -417,21 +559,39 @@ private:
 
 		_debugSizeUpdater guard{_m};
 		_m.end = newEnd;
+		if( grow )
+			_detail::OnRelocate(_m, nRelocated, newSize, capacity());
 	}
 
 
+	// Requires that elements are destroyed. Deallocates before allocating to halve the peak memory usage,
+	// so this is left empty if allocation throws. Caller does OnRelocate
+	void _replaceStorage(size_type const newCap)
+	{
+		if( newCap > max_size() )
+			_detail::LengthError::raise();
+
+		_resetData(nullptr, 0);
+		_m.end = nullptr;
+
+		auto const r = _allocateWrap::allocate(_m, newCap);
+		_m.data      = r.ptr;
+		_m.end       = r.ptr;
+		_m.reservEnd = r.ptr + r.count;
+	}
+
 	template< typename InputIter >
 	void _doAssign(InputIter src, size_type const count)
 	{
 		_debugSizeUpdater guard{_m};
 
+		bool const replace = capacity() < count;
 		if constexpr( can_memmove_with<T *, InputIter> )
 		{
-			if( capacity() < count )
-			{	// Deallocating first might be better,
-				// but then the _m pointers would have to be nulled in case allocate throws
-				_resetData(_allocateChecked(count), count);
-				_m.end = _m.reservEnd;
+			if( replace )
+			{
+				_replaceStorage(count);
+				_m.end = _m.data + count;
 			}
 			else
 			{	_m.end = _m.data + count;
@@ -451,13 +611,11 @@ private:
 			};
 
 			T * newEnd;
-			if( capacity() < count )
+			if( replace )
 			{
-				auto const newData = _allocateChecked(count);
 				_detail::Destroy(_m.data, _m.end);
-				_resetData(newData, count);
-				_m.end = newData;
-				newEnd = _m.reservEnd;
+				_replaceStorage(count);
+				newEnd = _m.data + count;
 			}
 			else
 			{	newEnd = _m.data + count;
@@ -477,6 +635,38 @@ private:
 			}
 			while( _m.end != newEnd );
 		}
+		if( replace )
+			_detail::OnRelocate(_m, 0, count, capacity());
+	}
+
+	template< typename InputIter, typename Sentinel >
+	void _appendUnsized(InputIter it, Sentinel const last)
+	{
+		// Each block is reported when it has been filled, or at the end
+		bool grown = false;
+		size_type nRelocated{};
+		while( it != last )
+		{
+			if( _m.end == _m.reservEnd )
+			{
+				if( grown )
+					_detail::OnRelocate(_m, nRelocated, size(), capacity());
+
+				grown = true;
+				nRelocated = _realloc(_calcCapAddOne(), size());
+			}
+
+			_debugSizeUpdater guard{_m};
+			// Fill the spare capacity without checking it for every element
+			T *const stop = _m.reservEnd;
+			do
+			{	_alloTrait::construct(_m, _m.end, *it);
+				++_m.end; ++it;
+			}
+			while( _m.end != stop and it != last );
+		}
+		if( grown )
+			_detail::OnRelocate(_m, nRelocated, size(), capacity());
 	}
 
 	template< typename InputIter >
@@ -504,15 +694,31 @@ private:
 
 	T * _insertReallocImpl(size_type const newCap, T *const pos, size_type const count)
 	{
-		auto const newData = _allocateWrap::allocate(_m, newCap);
-		// Exception free from here
 		auto const nBefore = pos - _m.data;
 		auto const nAfter  = _m.end - pos;
-		T *const newPos = _detail::Relocate(_m.data, nBefore, newData);
-		_m.end          = _detail::Relocate(pos, nAfter, newPos + count);
-
-		_resetData(newData, newCap);
-		return newPos;
+		if constexpr( oel::allocator_can_realloc<allocator_type>() )
+		{	// Growing in place is likely for a large block, then only the tail needs to move
+			auto const nRelocated = _realloc(newCap, size());
+
+			T *const newPos = _m.data + nBefore;
+			std::memmove(
+				static_cast<void *>(newPos + count),
+				static_cast<const void *>(newPos),
+				sizeof(T) * nAfter );
+			_m.end += count;
+			_detail::OnRelocate(_m, nRelocated + nAfter, size(), capacity());
+			return newPos;
+		}
+		else
+		{	auto const r = _allocateWrap::allocate(_m, newCap);
+			// Exception free from here
+			T *const newPos = _detail::Relocate(_m.data, nBefore, r.ptr);
+			_m.end          = _detail::Relocate(pos, nAfter, newPos + count);
+
+			_resetData(r.ptr, r.count);
+			_detail::OnRelocate(_m, nBefore + nAfter, size(), capacity());
+			return newPos;
+		}
 	}
 
 	T * _insRangeRealloc(T *const pos, size_type const count)
@@ -521,6 +727,68 @@ private:
 		return _insertReallocImpl(newCap, pos, count);
 	}
 
+	// Starting at src, with all before it kept, erases the elements for which isRemoved(elem, lastKept)
+	// returns true, by relocating runs of kept elements. lastKept is null if none. Requires trivially relocatable T
+	template< typename Func >
+	size_type _relocatingRemove(T * src, Func isRemoved)
+	{
+		_debugSizeUpdater guard{_m};
+
+		auto const oldEnd = _m.end;
+		T * dest  = src; // [dest, alive) are destroyed or relocated, [alive, end) are untouched
+		T * alive = src;
+		const T * lastKept = (src != _m.data) ? src - 1 : nullptr;
+		OEL_TRY_
+		{
+			for( ; src != _m.end; ++src )
+			{
+				if( isRemoved(*src, lastKept) )
+				{
+					if( dest != alive )
+						std::memmove(static_cast<void *>(dest), static_cast<const void *>(alive), sizeof(T) * (src - alive));
+
+					dest += src - alive;
+					src-> ~T();
+					alive = src + 1;
+					if( dest != _m.data )
+						lastKept = dest - 1;
+				}
+				else
+				{	lastKept = src;
+				}
+			}
+		}
+		OEL_CATCH_ALL
+		{	// fill hole
+			std::memmove(static_cast<void *>(dest), static_cast<const void *>(alive), sizeof(T) * (_m.end - alive));
+			_m.end = dest + (_m.end - alive);
+			OEL_RETHROW;
+		}
+		if( dest != alive )
+			std::memmove(static_cast<void *>(dest), static_cast<const void *>(alive), sizeof(T) * (_m.end - alive));
+
+		_m.end = dest + (_m.end - alive);
+		return static_cast<size_type>(oldEnd - _m.end);
+	}
+
+	// Relocates [pos, end) to [pos + count, end + count), leaving [pos, pos + count) uninitialized (conceptually).
+	// Returns pos, which changes if reallocation happens
+	T * _openGap(T *const pos, size_type const count)
+	{
+		if( _spareCapacity() >= count )
+		{
+			std::memmove(
+				static_cast<void *>(pos + count),
+				static_cast<const void *>(pos),
+				sizeof(T) * (_m.end - pos) );
+			_m.end += count;
+			return pos;
+		}
+		else
+		{	return _insRangeRealloc(pos, count);
+		}
+	}
+
 	T * _emplaceRealloc(T * pos, T * destroyOnFail)
 	{
 		struct Guard
@@ -571,7 +839,118 @@ typename dynarray<T, Alloc>::iterator
 	else
 	{	pPos = _emplaceRealloc(pPos, reinterpret_cast<T *>(&tmp));
 	}
+#if defined __GNUC__ and !defined __clang__
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 	std::memcpy(static_cast<void *>(pPos), &tmp, sizeof(T)); // relocate the new element to pos
+#if defined __GNUC__ and !defined __clang__
+	#pragma GCC diagnostic pop
+#endif
+
+	return _detail::MakeDynarrIter(_m, pPos);
+}
+
+template< typename T, typename Alloc >
+template< typename IndexRangePairs >
+void dynarray<T, Alloc>::insert_ranges(const IndexRangePairs & inserts)
+{
+	static_assert( is_trivially_relocatable<T>::value,
+		"insert_ranges requires trivially relocatable T, see declaration of is_trivially_relocatable" );
+
+	size_type total{};
+	for( auto const & e : inserts )
+		total += _detail::UDist(std::get<1>(e));
+
+	if( _spareCapacity() < total )
+		_growBy(total);
+
+	_debugSizeUpdater guard{_m};
+
+	auto const oldSize = size();
+	auto const first = oel::begin_(inserts);
+	auto it = oel::end_(inserts);
+	size_type segEnd = oldSize;
+	size_type shift  = total;
+	// From back to front, relocate the segment from index to segEnd, then construct in front of it
+	while( it != first )
+	{
+		--it;
+		auto const & src = std::get<1>(*it);
+		auto const index = static_cast<size_type>(std::get<0>(*it));
+		OEL_ASSERT(index <= segEnd);
+
+		T *const seg = _m.data + index;
+		std::memmove(static_cast<void *>(seg + shift), static_cast<const void *>(seg), sizeof(T) * (segEnd - index));
+
+		auto const count = _detail::UDist(src);
+		shift -= count;
+		T *const dFirst = seg + shift;
+		auto srcIt = oel::begin_(src);
+		if constexpr( can_memmove_with< T *, decltype(srcIt) > )
+		{
+			_detail::MemcpyCheck(srcIt, count, dFirst);
+		}
+		else
+		{	T * dest = dFirst;
+			OEL_TRY_
+			{
+				for( T *const dLast = dFirst + count; dest != dLast; ++dest, ++srcIt )
+					_alloTrait::construct(_m, dest, *srcIt);
+			}
+			OEL_CATCH_ALL
+			{
+				_detail::Destroy(dFirst, dest);
+				// Undo from this insert to the last, front to back
+				auto shiftBefore = shift + count;
+				std::memmove(static_cast<void *>(seg), static_cast<const void *>(seg + shiftBefore), sizeof(T) * (segEnd - index));
+				for( ++it; it != oel::end_(inserts); )
+				{
+					auto const i = static_cast<size_type>(std::get<0>(*it));
+					auto const n = _detail::UDist(std::get<1>(*it));
+					++it;
+					auto const end = (it != oel::end_(inserts)) ? static_cast<size_type>(std::get<0>(*it)) : oldSize;
+
+					T *const s = _m.data + i;
+					_detail::Destroy(s + shiftBefore, s + shiftBefore + n);
+					shiftBefore += n;
+					std::memmove(static_cast<void *>(s), static_cast<const void *>(s + shiftBefore), sizeof(T) * (end - i));
+				}
+				OEL_RETHROW;
+			}
+		}
+		segEnd = index;
+	}
+	_m.end += total;
+}
+
+template< typename T, typename Alloc >
+typename dynarray<T, Alloc>::iterator
+	dynarray<T, Alloc>::splice(const_iterator pos, dynarray & other, const_iterator first, const_iterator last) &
+{
+	static_assert( is_trivially_relocatable<T>::value,
+		"splice requires trivially relocatable T, see declaration of is_trivially_relocatable" );
+	OEL_ASSERT(&other != this);
+
+	_debugSizeUpdater guard{_m};
+	_debugSizeUpdater guardOther{other._m};
+
+	auto pPos = const_cast<T *>(to_pointer_contiguous(pos));
+	auto const pFirst = const_cast<T *>(to_pointer_contiguous(first));
+	auto const pLast  = const_cast<T *>(to_pointer_contiguous(last));
+	OEL_ASSERT(_m.data <= pPos and pPos <= _m.end);
+	OEL_ASSERT(other._m.data <= pFirst and pFirst <= pLast and pLast <= other._m.end);
+
+	auto const count = static_cast<size_type>(pLast - pFirst);
+	pPos = _openGap(pPos, count);
+	// Exception free from here
+	_detail::MemcpyCheck(pFirst, count, pPos);
+
+	std::memmove(
+		static_cast<void *>(pFirst),
+		static_cast<const void *>(pLast),
+		sizeof(T) * (other._m.end - pLast) );
+	other._m.end -= count;
 
 	return _detail::MakeDynarrIter(_m, pPos);
 }
@@ -591,18 +970,8 @@ typename dynarray<T, Alloc>::iterator
 	auto const count = _detail::UDist(source);
 
 	size_t const bytesAfterPos{sizeof(T) * (_m.end - pPos)};
-	T * dLast;
-	if( _spareCapacity() >= count )
-	{
-		dLast = pPos + count;
-		// Relocate elements to make space, leaving [pos, pos + count) uninitialized (conceptually)
-		std::memmove(static_cast<void *>(dLast), static_cast<const void *>(pPos), bytesAfterPos);
-		_m.end += count;
-	}
-	else
-	{	pPos  = _insRangeRealloc(pPos, count);
-		dLast = pPos + count;
-	}
+	pPos = _openGap(pPos, count);
+	T *const dLast = pPos + count;
 	// Construct new
 	if constexpr( can_memmove_with< T *, decltype(first) > )
 	{
@@ -636,7 +1005,8 @@ template< typename T, typename Alloc >
 void dynarray<T, Alloc>::_growBy(size_type const count)
 {
 	auto const s = size();
-	_realloc(_calcCapAdd(count, s), s);
+	auto const nRelocated = _realloc(_calcCapAdd(count, s), s);
+	_detail::OnRelocate(_m, nRelocated, s + count, capacity());
 }
 
 template< typename T, typename Alloc >
@@ -665,13 +1035,114 @@ inline void dynarray<T, Alloc>::append_range(InputRange && source)
 		_doAppend(oel::begin_(source), _detail::UDist(source));
 	}
 	else
-	{	auto it = oel::begin_(source);
-		auto l  = oel::end_(source);
-		for( ; it != l; ++it )
-			emplace_back(*it);
+	{	if( auto const hint = _detail::ReserveHint(source, int{}) )
+			reserve(size() + hint);
+
+		_appendUnsized(oel::begin_(source), oel::end_(source));
 	}
 }
 
+template< typename T, typename Alloc >
+void dynarray<T, Alloc>::adopt(dynarray_buffer<T> const b)
+{
+	OEL_ASSERT(b.size <= b.capacity);
+
+#if OEL_MEM_BOUND_DEBUG_LVL
+	// Blocks need a header in front
+	auto const r = _allocateChecked(b.capacity);
+	_detail::Relocate(b.data, b.size, r.ptr);
+	if( b.data )
+		_alloTrait::deallocate(_m, b.data, b.capacity);
+
+	T *const newData = r.ptr;
+	auto const newCap = r.count;
+#else
+	T *const newData = b.data;
+	auto const newCap = b.capacity;
+#endif
+	_detail::Destroy(_m.data, _m.end);
+	_resetData(newData, newCap);
+	_m.end = newData + b.size;
+	(void) _debugSizeUpdater{_m};
+}
+
+template< typename T, typename Alloc >
+dynarray_buffer<T> dynarray<T, Alloc>::release()
+{
+	dynarray_buffer<T> b{_m.data, size(), capacity()};
+#if OEL_MEM_BOUND_DEBUG_LVL
+	if( _m.data )
+	{	// Hand out a block without header
+		b.data = _alloTrait::allocate(_m, b.capacity);
+		_detail::Relocate(_m.data, b.size, b.data);
+		_allocateWrap::dealloc(_m, _m.data, b.capacity);
+	}
+#endif
+	_m.data = _m.end = _m.reservEnd = nullptr;
+	return b;
+}
+
+template< typename T, typename Alloc >
+void dynarray<T, Alloc>::append(dynarray && other)
+{
+	OEL_ASSERT(&other != this);
+
+	allocator_type & a = _m;
+	allocator_type & b = other._m;
+	if( empty() and a == b )
+	{
+		_resetData(other._m.data, other.capacity());
+		_m.end = other._m.end;
+		other._m.data = other._m.end = other._m.reservEnd = nullptr;
+	}
+	else
+	{	auto const n = other.size();
+		if( _spareCapacity() < n )
+			_growBy(n);
+
+		_debugSizeUpdater guard{_m};
+		_debugSizeUpdater guardOther{other._m};
+		_m.end = _detail::Relocate(other._m.data, n, _m.end);
+		other._m.end = other._m.data;
+	}
+}
+
+template< typename T, typename Alloc >
+template< typename Operation >
+void dynarray<T, Alloc>::append_and_overwrite(size_type const maxCount, Operation op)
+{
+	// Not _growBy, as the size this ends with is not known yet
+	bool const grow = _spareCapacity() < maxCount;
+	size_type nRelocated{};
+	if( grow )
+	{
+		auto const s = size();
+		nRelocated = _realloc(_calcCapAdd(maxCount, s), s);
+	}
+
+	T *const first = _m.end;
+	T *const last  = first + maxCount;
+	_detail::DefaultInit::call(first, last, static_cast<allocator_type &>(_m));
+
+	size_type count{};
+	OEL_TRY_
+	{
+		count = static_cast<size_type>(op(first, maxCount));
+	}
+	OEL_CATCH_ALL
+	{
+		_detail::Destroy(first, last);
+		OEL_RETHROW;
+	}
+	OEL_ASSERT(count <= maxCount);
+	_detail::Destroy(first + count, last);
+
+	_debugSizeUpdater guard{_m};
+	_m.end = first + count;
+	if( grow )
+		_detail::OnRelocate(_m, nRelocated, size(), capacity());
+}
+
 template< typename T, typename Alloc >
 template< typename InputRange >
 inline void dynarray<T, Alloc>::assign_range(InputRange && source)
@@ -692,9 +1163,9 @@ dynarray<T, Alloc>::dynarray(size_type n, for_overwrite_t, Alloc a)
  :	_m(a)
 {
 	_initReserve(n);
-	_detail::DefaultInit::call<allocator_type>(_m.data, _m.reservEnd, _m);
+	_detail::DefaultInit::call<allocator_type>(_m.data, _m.data + n, _m);
 
-	_m.end = _m.reservEnd;
+	_m.end = _m.data + n;
 	(void) _debugSizeUpdater{_m};
 }
 
@@ -702,10 +1173,17 @@ template< typename T, typename Alloc >
 dynarray<T, Alloc>::dynarray(size_type n, Alloc a)
  :	_m(a)
 {
-	_initReserve(n);
-	_detail::ValueInit::call<allocator_type>(_m.data, _m.reservEnd, _m);
-
-	_m.end = _m.reservEnd;
+	if constexpr( _detail::zeroIsValueInit<T> )
+	{	// Fresh pages from calloc or mmap are zeroed lazily by the OS, so a huge array is not touched here
+		auto const r = _allocateZeroedChecked(n);
+		_m.data = r.ptr;
+		_m.reservEnd = r.ptr + r.count;
+	}
+	else
+	{	_initReserve(n);
+		_detail::ValueInit::call<allocator_type>(_m.data, _m.data + n, _m);
+	}
+	_m.end = _m.data + n;
 	(void) _debugSizeUpdater{_m};
 }
 
@@ -770,7 +1248,8 @@ void dynarray<T, Alloc>::shrink_to_fit()
 	auto const used = size();
 	if( 0 < used )
 	{
-		_realloc(used, used);
+		auto const nRelocated = _realloc(used, used);
+		_detail::OnRelocate(_m, nRelocated, used, capacity());
 	}
 	else
 	{	_m.end = nullptr;
@@ -790,6 +1269,134 @@ void dynarray<T, Alloc>::erase_to_end(const_iterator first) noexcept
 	(void) _debugSizeUpdater{_m};
 }
 
+template< typename T, typename Alloc >
+template< typename UnaryPredicate >
+typename dynarray<T, Alloc>::size_type dynarray<T, Alloc>::remove_if(UnaryPredicate p)
+{
+	auto pred = [&p](T & elem) -> bool { return p(elem); };
+
+	auto const first = std::find_if(_m.data, _m.end, pred);
+	if constexpr( is_trivially_relocatable<T>::value )
+	{
+		return _relocatingRemove(first, [&pred](T & elem, const T *) { return pred(elem); });
+	}
+	else
+	{	auto const newEnd = std::remove_if(first, _m.end, pred);
+		auto const n = static_cast<size_type>(_m.end - newEnd);
+		erase_to_end(_detail::MakeDynarrIter(_m, newEnd));
+		return n;
+	}
+}
+
+template< typename T, typename Alloc >
+typename dynarray<T, Alloc>::size_type dynarray<T, Alloc>::unique()
+{
+	auto const first = std::adjacent_find(_m.data, _m.end);
+	if( first == _m.end )
+		return 0;
+
+	if constexpr( is_trivially_relocatable<T>::value )
+	{
+		return _relocatingRemove(first + 1, [](const T & elem, const T * lastKept) -> bool { return *lastKept == elem; });
+	}
+	else
+	{	auto const newEnd = std::unique(first, _m.end);
+		auto const n = static_cast<size_type>(_m.end - newEnd);
+		erase_to_end(_detail::MakeDynarrIter(_m, newEnd));
+		return n;
+	}
+}
+
+template< typename T, typename Alloc >
+template< typename SortedIndexRange >
+void dynarray<T, Alloc>::unordered_erase_indices(const SortedIndexRange & indices)
+{
+	auto lo = oel::begin_(indices);
+	auto hi = oel::end_(indices);
+
+	_debugSizeUpdater guard{_m};
+
+	T * keptEnd = _m.end;
+	while( lo != hi )
+	{
+		auto greatest = hi;
+		--greatest;
+		auto const i = static_cast<size_type>(*greatest);
+		OEL_ASSERT(i < size());
+
+		T *const p = _m.data + i;
+		if( p >= keptEnd - 1 )
+		{	// Erasing at the end, or a duplicate index
+			if( p == keptEnd - 1 )
+			{
+				--keptEnd;
+				if constexpr( is_trivially_relocatable<T>::value )
+					keptEnd->~T();
+			}
+			hi = greatest;
+		}
+		else
+		{	// keptEnd[-1] is to be kept, move it into the smallest hole
+			auto const holeIdx = *lo;
+			T *const hole = _m.data + holeIdx;
+			--keptEnd;
+			if constexpr( is_trivially_relocatable<T>::value )
+			{
+				hole->~T();
+				_detail::Relocate(keptEnd, 1, hole);
+			}
+			else
+			{	*hole = std::move(*keptEnd);
+			}
+			do
+			{	++lo;
+			} while( lo != hi and *lo == holeIdx );
+		}
+	}
+	if constexpr( is_trivially_relocatable<T>::value )
+		_m.end = keptEnd;
+	else
+		_detail::Destroy(keptEnd, std::exchange(_m.end, keptEnd));
+}
+
+template< typename T, typename Alloc >
+template< typename SortedIndexRange >
+void dynarray<T, Alloc>::erase_indices(const SortedIndexRange & indices)
+{
+	auto it = oel::begin_(indices);
+	auto const last = oel::end_(indices);
+	if( it == last )
+		return;
+
+	_debugSizeUpdater guard{_m};
+
+	auto const oldSize = size();
+	T * dest = _m.data + *it;
+	while( it != last )
+	{
+		auto const i = static_cast<size_type>(*it);
+		++it;
+		auto const next = (it != last) ? static_cast<size_type>(*it) : oldSize;
+		OEL_ASSERT(i < next and next <= oldSize);
+
+		T *const runFirst = _m.data + i + 1;
+		auto const nRun = next - i - 1;
+		if constexpr( is_trivially_relocatable<T>::value )
+		{
+			runFirst[-1].~T();
+			std::memmove(static_cast<void *>(dest), static_cast<const void *>(runFirst), sizeof(T) * nRun);
+			dest += nRun;
+		}
+		else
+		{	dest = std::move(runFirst, runFirst + nRun, dest);
+		}
+	}
+	if constexpr( is_trivially_relocatable<T>::value )
+		_m.end = dest;
+	else
+		_detail::Destroy(dest, std::exchange(_m.end, dest));
+}
+
 template< typename T, typename Alloc >
 inline void dynarray<T, Alloc>::unordered_erase(iterator pos)
 {
@@ -0,0 +1,113 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "auxi/core_util.h"
+
+#include <cstdint>
+
+/** @file
+* @brief Policies for how much dynarray increases capacity when it has to reallocate
+*
+* A policy is selected with a member type in the allocator, for example:
+@code
+template< typename T >
+struct MyAlloc : oel::allocator<T>
+{
+	using growth_policy = oel::growth_factor<3, 2>;
+};
+oel::dynarray< int, MyAlloc<int> > d;
+@endcode
+* Without `Alloc::growth_policy`, dynarray uses growth_factor<2, 1>.
+*
+* To write a custom policy, provide the two static member functions that growth_factor has. */
+
+namespace oel
+{
+
+//! Multiplies capacity by Num / Den, but at least to the needed capacity
+template< size_t Num, size_t Den >
+struct growth_factor
+{
+	static_assert(Num > Den and Den > 0);
+
+	//! Returns capacity to use when at least minCapacity is needed (reserve, resize and all functions that append)
+	static constexpr size_t grow(size_t capacity, size_t minCapacity, size_t /*elemSize*/) noexcept
+		{
+			auto const c = _scale(capacity, Num);
+			return c > minCapacity ? c : minCapacity;
+		}
+
+	//! Returns capacity to use when adding one element to a full container. Grows by at least 3 pointers worth of bytes
+	static constexpr size_t grow_one(size_t capacity, size_t elemSize) noexcept
+		{
+			constexpr auto startBytesGood = 3 * sizeof(void *) > 4 * sizeof(int) ? 3 * sizeof(void *) : 4 * sizeof(int);
+			auto const minGrow = (startBytesGood + elemSize - 1) / elemSize;
+			auto const add = _scale(capacity, Num - Den);
+			return capacity + (add > minGrow ? add : minGrow);
+		}
+
+	static constexpr size_t _scale(size_t n, size_t factorNum)
+	{
+		return n / Den * factorNum + n % Den * factorNum / Den;
+	}
+};
+
+//! Growth by 1.5, then rounded up to fill a size class of typical malloc implementations
+/**
+* Size classes are modeled on jemalloc and TCMalloc: multiples of 16 bytes up to 128, then four classes
+* per doubling. Memory that the allocator would waste anyway is instead made available as capacity. */
+struct growth_size_class
+{
+	static constexpr size_t grow(size_t capacity, size_t minCapacity, size_t elemSize) noexcept
+		{
+			auto const c = _roundUp(growth_factor<3, 2>::grow(capacity, minCapacity, elemSize), elemSize);
+			return c > minCapacity ? c : minCapacity;
+		}
+
+	static constexpr size_t grow_one(size_t capacity, size_t elemSize) noexcept
+		{
+			return _roundUp(growth_factor<3, 2>::grow_one(capacity, elemSize), elemSize);
+		}
+
+	//! Smallest size class that holds nBytes, or nBytes unchanged if greater than SIZE_MAX / 2
+	static constexpr size_t round_up_bytes(size_t nBytes) noexcept
+		{
+			if( nBytes > SIZE_MAX / 2 ) // no allocation can succeed, and rounding would overflow
+				return nBytes;
+
+			size_t step = 16;
+			if( nBytes > 128 )
+			{
+				size_t highBit = 128;
+				while( highBit * 2 < nBytes )
+					highBit *= 2;
+
+				step = highBit / 4;
+			}
+			return (nBytes + (step - 1)) & ~(step - 1);
+		}
+
+	static constexpr size_t _roundUp(size_t count, size_t elemSize)
+	{
+		if( count > SIZE_MAX / 2 / elemSize )
+			return count;
+		else
+			return round_up_bytes(count * elemSize) / elemSize;
+	}
+};
+
+
+namespace _detail
+{
+	template< typename Alloc >
+	typename Alloc::growth_policy GrowthPolicy(int);
+
+	template< typename > growth_factor<2, 1> GrowthPolicy(long);
+}
+
+} // namespace oel
@@ -0,0 +1,304 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "allocator.h"
+
+#include <cstring>
+
+#ifndef OEL_HAS_MREMAP
+	#if defined __linux__ and __has_include(<sys/mman.h>)
+	#define OEL_HAS_MREMAP  1
+	#else
+	#define OEL_HAS_MREMAP  0
+	#endif
+#endif
+
+#if OEL_HAS_MREMAP
+#include <sys/mman.h>
+#endif
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+/** @file
+*/
+
+namespace oel
+{
+
+//! Flags for the Options parameter of large_block_allocator, can be combined with |
+struct large_block_option
+{
+	//! Align large blocks to 2 MiB and madvise(MADV_HUGEPAGE), for fewer TLB misses with random access
+	static constexpr unsigned huge_pages = 1;
+	//! Populate the pages of large blocks when allocating, so that the first pass does not take page faults
+	static constexpr unsigned prefault   = 2;
+};
+
+//! Allocates blocks of at least ThresholdBytes directly with mmap, and grows them with mremap
+/**
+* For the large blocks, the kernel moves page mappings instead of copying bytes, so growing a dynarray of
+* several GB becomes cheap. Smaller blocks are handled exactly like oel::allocator.
+*
+* Requires that the old count is passed to reallocate, which dynarray does. Where mremap is not available
+* (OEL_HAS_MREMAP is 0, anything but Linux), all blocks are handled like oel::allocator.
+*
+* @tparam Options zero or more of large_block_option. With huge_pages, each large block is rounded up
+*	to a multiple of 2 MiB. After mremap has moved a block, it is not guaranteed to be 2 MiB aligned. */
+template< typename T, size_t ThresholdBytes = size_t{1} << 21, unsigned Options = 0 >
+class large_block_allocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_move_assignment = std::true_type;
+
+	template< typename U >
+	struct rebind
+	{
+		using other = large_block_allocator<U, ThresholdBytes, Options>;
+	};
+
+	static constexpr bool   can_reallocate() noexcept { return allocator<T>::can_reallocate(); }
+
+	static constexpr size_t max_size() noexcept       { return allocator<T>::max_size(); }
+
+	static T *  allocate(size_t count);
+	//! Memory is all zero bytes. Large blocks are fresh pages from mmap, so this costs no more than allocate
+	static T *  allocate_zeroed(size_t count);
+
+	//! Like oel::allocator::reallocate, except that oldCount must be the count that ptr was allocated with
+	static T *  reallocate(T * ptr, size_t oldCount, size_t newCount);
+
+	static void deallocate(T * ptr, size_t count) noexcept;
+
+	large_block_allocator() = default;
+
+	template< typename U >  OEL_ALWAYS_INLINE
+	constexpr large_block_allocator(large_block_allocator<U, ThresholdBytes, Options>) noexcept {}
+
+	friend constexpr bool operator==(large_block_allocator, large_block_allocator) noexcept  { return true; }
+	friend constexpr bool operator!=(large_block_allocator, large_block_allocator) noexcept  { return false; }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	static constexpr bool _isLarge(size_t count)
+	{
+		return OEL_HAS_MREMAP and sizeof(T) * count >= ThresholdBytes;
+	}
+};
+
+//! Touch the memory pages of the spare capacity of d, to take the page faults now rather than in a later hot loop
+/**
+* Intended before resize_for_overwrite or appending to a large dynarray. Works with any allocator. */
+template< typename T, typename Alloc >
+void prefault_spare_capacity(dynarray<T, Alloc> & d) noexcept;
+
+namespace _detail
+{
+	inline constexpr size_t hugePageSize = size_t{1} << 21;
+
+	inline size_t PageSize() noexcept
+	{
+	#ifdef _SC_PAGESIZE
+		static auto const size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return size;
+	#else
+		return 4096;
+	#endif
+	}
+
+	// Requires that p is page aligned. Writing is only allowed if there are no objects in the range
+	inline void Prefault(void *const p, size_t const nBytes) noexcept
+	{
+	#if OEL_HAS_MREMAP and defined MADV_POPULATE_WRITE
+		if( ::madvise(p, nBytes, MADV_POPULATE_WRITE) == 0 )
+			return;
+	#endif
+		auto const step = _detail::PageSize();
+		for( size_t i{}; i < nBytes; i += step )
+			static_cast<volatile unsigned char *>(p)[i] = 0;
+	}
+
+	// Length of the mapping for a block of nBytes
+	template< unsigned Options >
+	size_t MapLength(size_t const nBytes)
+	{
+		if constexpr( Options & large_block_option::huge_pages )
+			return (nBytes + (hugePageSize - 1)) & ~(hugePageSize - 1);
+		else
+			return nBytes;
+	}
+
+#if OEL_HAS_MREMAP
+	template< unsigned Options >
+	struct Mmap
+	{
+		static void * call(size_t const nBytes)
+		{
+			constexpr bool huge = Options & large_block_option::huge_pages;
+			constexpr bool prefault = Options & large_block_option::prefault;
+
+			auto const len = _detail::MapLength<Options>(nBytes);
+			int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+			if constexpr( prefault and !huge )
+				flags |= MAP_POPULATE;
+
+			void * p = ::mmap(nullptr, huge ? len + hugePageSize : len, PROT_READ | PROT_WRITE, flags, -1, 0);
+			if( p == MAP_FAILED )
+				return nullptr;
+
+			if constexpr( huge )
+			{	// Mapped an extra huge page, unmap the parts before and after the aligned block
+				auto const addr = reinterpret_cast<std::uintptr_t>(p);
+				auto const aligned = (addr + (hugePageSize - 1)) & ~(hugePageSize - 1);
+				auto const head = aligned - addr;
+				if( head != 0 )
+					::munmap(p, head);
+				if( head != hugePageSize )
+					::munmap(reinterpret_cast<void *>(aligned + len), hugePageSize - head);
+
+				p = reinterpret_cast<void *>(aligned);
+			#ifdef MADV_HUGEPAGE
+				::madvise(p, len, MADV_HUGEPAGE);
+			#endif
+				if constexpr( prefault )
+					_detail::Prefault(p, len);
+			}
+			return p;
+		}
+	};
+
+	template< unsigned Options >
+	struct Mremap
+	{
+		static void * call(size_t const nBytes, void * old, size_t const oldBytes)
+		{
+			auto const len    = _detail::MapLength<Options>(nBytes);
+			auto const oldLen = _detail::MapLength<Options>(oldBytes);
+			void * p = ::mremap(old, oldLen, len, MREMAP_MAYMOVE);
+			if( p == MAP_FAILED )
+				return nullptr;
+
+			if constexpr( (Options & large_block_option::prefault) != 0 )
+			{
+				auto const from = oldLen & ~(_detail::PageSize() - 1);
+				if( from < len )
+					_detail::Prefault(static_cast<char *>(p) + from, len - from);
+			}
+			return p;
+		}
+	};
+
+	template< unsigned Options >
+	void Munmap(void * p, size_t const nBytes) noexcept
+	{
+		::munmap(p, _detail::MapLength<Options>(nBytes));
+	}
+#else
+	template< unsigned >
+	using Mmap = Malloc<OEL_MALLOC_ALIGNMENT>;
+
+	template< unsigned >
+	struct Mremap
+	{
+		static void * call(size_t, void *, size_t)  { return nullptr; } // never called
+	};
+
+	template< unsigned >
+	void Munmap(void *, size_t) noexcept {}
+#endif
+
+	inline void PrefaultRange(unsigned char * first, unsigned char *const last) noexcept
+	{
+		if( first != last )
+		{
+			static_cast<volatile unsigned char &>(*first) = 0;
+
+			auto const page = _detail::PageSize();
+			auto const offset = reinterpret_cast<std::uintptr_t>(first) & (page - 1);
+			first += page - offset;
+			if( first < last )
+				_detail::Prefault(first, last - first);
+		}
+	}
+}
+
+template< typename T, size_t ThresholdBytes, unsigned Options >
+[[nodiscard]] T * large_block_allocator<T, ThresholdBytes, Options>::allocate(size_t count)
+{
+	if( _isLarge(count) )
+		return static_cast<T *>( _detail::AllocAndHandleFail<_detail::Mmap<Options>, false>(sizeof(T) * count) );
+	else
+		return allocator<T>::allocate(count);
+}
+
+template< typename T, size_t ThresholdBytes, unsigned Options >
+[[nodiscard]] T * large_block_allocator<T, ThresholdBytes, Options>::allocate_zeroed(size_t count)
+{
+	if( _isLarge(count) )
+		return allocate(count);
+	else
+		return allocator<T>::allocate_zeroed(count);
+}
+
+template< typename T, size_t ThresholdBytes, unsigned Options >
+[[nodiscard]] T * large_block_allocator<T, ThresholdBytes, Options>::reallocate(T * ptr, size_t oldCount, size_t count)
+{
+	OEL_ASSERT(0 < count and count <= max_size());
+
+	if( !ptr )
+		return allocate(count);
+
+	bool const wasLarge = _isLarge(oldCount);
+	if( wasLarge == _isLarge(count) )
+	{
+		if( wasLarge )
+		{
+			using F = _detail::Mremap<Options>;
+			void * vp{ptr};
+			return static_cast<T *>( _detail::AllocAndHandleFail<F, false>(sizeof(T) * count, vp, sizeof(T) * oldCount) );
+		}
+		else
+		{	return allocator<T>::reallocate(ptr, count);
+		}
+	}
+	else
+	{	// Crossing the threshold, copy between malloc and mmap blocks
+		auto const p = allocate(count);
+		auto const n = oldCount < count ? oldCount : count;
+		std::memcpy(static_cast<void *>(p), static_cast<const void *>(ptr), sizeof(T) * n);
+		deallocate(ptr, oldCount);
+		return p;
+	}
+}
+
+template< typename T, size_t ThresholdBytes, unsigned Options >
+inline void large_block_allocator<T, ThresholdBytes, Options>::deallocate(T * ptr, size_t count) noexcept
+{
+	if( _isLarge(count) )
+		_detail::Munmap<Options>(ptr, sizeof(T) * count);
+	else
+		allocator<T>::deallocate(ptr, count);
+}
+
+template< typename T, typename Alloc >
+void prefault_spare_capacity(dynarray<T, Alloc> & d) noexcept
+{
+	auto const first = reinterpret_cast<unsigned char *>(d.data() + d.size());
+	auto const last  = reinterpret_cast<unsigned char *>(d.data() + d.capacity());
+	_detail::PrefaultRange(first, last);
+}
+
+} // namespace oel
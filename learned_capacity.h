@@ -0,0 +1,76 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "util.h"
+
+#include <atomic>
+
+/** @file
+*/
+
+namespace oel
+{
+
+//! Learns the size that containers made at one call site end up with, to reserve that up front next time
+/**
+* Intended as a static local, one for each place in the code that builds a container by appending
+* one element at a time to a size that varies little between calls:
+@code
+oel::dynarray<Item> collectItems(const Input & in)
+{
+	static oel::learned_capacity site;
+	auto items = site.make< oel::dynarray<Item> >();
+	for (auto & x : in)
+		if (x.wanted())
+			items.emplace_back(x);
+
+	site.record(items.size());
+	return items;
+}
+@endcode
+* The hint jumps up to any larger size recorded, and decays by 1/8 of the difference towards
+* a smaller size, so a single outlier does not make every later container large.
+* Safe to use from several threads, then the hint is from one of the recent sizes. */
+class learned_capacity
+{
+public:
+	//! Capacity to reserve, or 0 before any size has been recorded
+	size_t hint() const noexcept  { return _hint.load(std::memory_order_relaxed); }
+
+	//! Call with the size a container ended up with
+	void record(size_t size) noexcept;
+
+	//! Returns a Container with capacity hint(), constructed with `(reserve, hint(), args...)`, or just `(args...)` if 0
+	template< typename Container, typename... Args >
+	Container make(Args &&... args) const;
+
+private:
+	std::atomic<size_t> _hint{};
+};
+
+
+
+inline void learned_capacity::record(size_t const size) noexcept
+{
+	auto const old = hint();
+	auto const h = (size >= old) ? size : old - (old - size) / 8;
+	if( h != old )
+		_hint.store(h, std::memory_order_relaxed);
+}
+
+template< typename Container, typename... Args >
+Container learned_capacity::make(Args &&... args) const
+{
+	auto const n = hint();
+	if( n != 0 )
+		return Container(reserve, n, static_cast<Args &&>(args)...);
+	else
+		return Container(static_cast<Args &&>(args)...);
+}
+
+} // namespace oel
@@ -7,7 +7,9 @@
 
 
 #include "dynarray.h"
+#include "auxi/bump_chunks.h"
 
+#include <cstring>
 #include <memory_resource>
 
 //! Mirroring std::pmr and boost::container::pmr
@@ -22,4 +24,233 @@ using dynarray = oel::dynarray< T, polymorphic_allocator<std::byte> >;
 //! Same as oel::to_dynarray, except always with polymorphic_allocator
 inline auto to_dynarray(polymorphic_allocator<std::byte> a = {})  { return oel::to_dynarray(a); }
 
-}
\ No newline at end of file
+
+//! A std::pmr::memory_resource that can also resize a block, possibly without moving it
+/**
+* Derived classes override do_reallocate if they are able to grow or shrink a block in place,
+* the default allocates a new block, copies the bytes and deallocates the old. */
+class realloc_memory_resource : public std::pmr::memory_resource
+{
+public:
+	//! Like C `realloc`, except for failure handling, which is the same as allocate
+	/**
+	* The contents are preserved up to the smaller of the sizes. On failure, p is untouched.
+	* @param p must have been allocated from *this with oldBytes and alignment, or be null if oldBytes is 0 */
+	[[nodiscard]] void * reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment = alignof(std::max_align_t))
+	{
+		return do_reallocate(p, oldBytes, newBytes, alignment);
+	}
+
+protected:
+	virtual void * do_reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment);
+};
+
+//! Returns a pointer to a static realloc_memory_resource that uses malloc and realloc
+/**
+* Handles failure the same way as oel::allocator. Blocks aligned more than OEL_MALLOC_ALIGNMENT
+* come from std::pmr::new_delete_resource(), and are not grown in place. */
+realloc_memory_resource * malloc_resource() noexcept;
+
+//! Like std::pmr::monotonic_buffer_resource, but the most recently allocated block can grow in place
+/**
+* A dynarray that is the only one appending into the resource at a time will extend its block
+* until the current chunk is full, rather than leave a trail of abandoned blocks. Deallocating the most
+* recent block also gives back its space. Not thread-safe. */
+class monotonic_realloc_resource : public realloc_memory_resource
+{
+public:
+	explicit monotonic_realloc_resource(std::pmr::memory_resource * upstream = std::pmr::get_default_resource()) noexcept
+	 :	_bump{1024}, _upstream{upstream} {}
+	//! The first chunk requested from upstream will be at least initialSize bytes
+	explicit monotonic_realloc_resource(size_t initialSize, std::pmr::memory_resource * upstream = std::pmr::get_default_resource()) noexcept
+	 :	_bump{initialSize}, _upstream{upstream} {}
+
+	monotonic_realloc_resource(const monotonic_realloc_resource &) = delete;
+	monotonic_realloc_resource & operator =(const monotonic_realloc_resource &) = delete;
+
+	~monotonic_realloc_resource()  { release(); }
+
+	//! Returns all chunks to the upstream resource
+	void release() noexcept;
+
+	std::pmr::memory_resource * upstream_resource() const noexcept  { return _upstream; }
+
+protected:
+	void * do_allocate(size_t bytes, size_t alignment) override;
+
+	void   do_deallocate(void * p, size_t bytes, size_t alignment) override;
+
+	void * do_reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment) override;
+
+	bool   do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+		{
+			return this == &other;
+		}
+
+private:
+	using _chunkHeader = _detail::BumpChunks::Header;
+
+	_detail::BumpChunks _bump;
+	std::pmr::memory_resource *const _upstream;
+};
+
+//! Like std::pmr::polymorphic_allocator, but with realloc_memory_resource, and exposes reallocate to dynarray
+/**
+* Default constructed, it uses malloc_resource(). Copy construction of a dynarray gives the
+* new copy a default constructed allocator, same as with std::pmr::polymorphic_allocator.
+* Unlike that, this does not do uses-allocator construction of the elements. */
+template< typename T >
+class realloc_polymorphic_allocator
+{
+public:
+	using value_type = T;
+
+	static constexpr bool can_reallocate() noexcept { return is_trivially_relocatable<T>::value; }
+
+	static constexpr size_t max_size() noexcept     { return SIZE_MAX / sizeof(T); }
+
+	realloc_polymorphic_allocator() noexcept : _res{pmr::malloc_resource()} {}
+
+	realloc_polymorphic_allocator(realloc_memory_resource * r) noexcept
+	 :	_res{r} { OEL_ASSERT(r); }
+
+	template< typename U >
+	realloc_polymorphic_allocator(const realloc_polymorphic_allocator<U> & other) noexcept
+	 :	_res{other.resource()} {}
+
+	realloc_polymorphic_allocator & operator =(const realloc_polymorphic_allocator &) = delete;
+
+	[[nodiscard]] T * allocate(size_t count)
+		{
+			if( count > max_size() )
+				oel::_detail::BadAlloc::raise();
+			return static_cast<T *>( _res->allocate(sizeof(T) * count, alignof(T)) );
+		}
+	//! oldCount must be the count that ptr was allocated with
+	[[nodiscard]] T * reallocate(T * ptr, size_t oldCount, size_t newCount)
+		{
+			if( newCount > max_size() )
+				oel::_detail::BadAlloc::raise();
+			return static_cast<T *>( _res->reallocate(ptr, sizeof(T) * oldCount, sizeof(T) * newCount, alignof(T)) );
+		}
+
+	void deallocate(T * ptr, size_t count) noexcept
+		{
+			_res->deallocate(ptr, sizeof(T) * count, alignof(T));
+		}
+
+	realloc_polymorphic_allocator select_on_container_copy_construction() const noexcept
+		{
+			return {};
+		}
+
+	realloc_memory_resource * resource() const noexcept  { return _res; }
+
+	template< typename U >
+	friend bool operator==(realloc_polymorphic_allocator a, realloc_polymorphic_allocator<U> b) noexcept
+		{
+			return *a.resource() == *b.resource();
+		}
+	template< typename U >
+	friend bool operator!=(realloc_polymorphic_allocator a, realloc_polymorphic_allocator<U> b) noexcept
+		{
+			return !(a == b);
+		}
+
+private:
+	realloc_memory_resource * _res;
+};
+
+//! dynarray that grows in place when the memory resource is able to
+template< typename T >
+using realloc_dynarray = oel::dynarray< T, realloc_polymorphic_allocator<std::byte> >;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+inline void * realloc_memory_resource::do_reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment)
+{
+	auto const newP = allocate(newBytes, alignment);
+	if( p )
+	{
+		std::memcpy(newP, p, oldBytes < newBytes ? oldBytes : newBytes);
+		deallocate(p, oldBytes, alignment);
+	}
+	return newP;
+}
+
+namespace _detail
+{
+	class MallocResource final : public realloc_memory_resource
+	{
+		using _malloc  = oel::_detail::Malloc<OEL_MALLOC_ALIGNMENT>;
+		using _realloc = oel::_detail::Realloc<OEL_MALLOC_ALIGNMENT>;
+
+		static bool _isOverAligned(size_t alignment) noexcept  { return alignment > OEL_MALLOC_ALIGNMENT; }
+
+		void * do_allocate(size_t bytes, size_t alignment) override
+		{
+			if( _isOverAligned(alignment) )
+				return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+			else // malloc may return null for zero size
+				return oel::_detail::AllocAndHandleFail<_malloc, false>(bytes + (bytes == 0));
+		}
+
+		void do_deallocate(void * p, size_t bytes, size_t alignment) override
+		{
+			if( _isOverAligned(alignment) )
+				std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+			else
+				oel::_detail::Free<OEL_MALLOC_ALIGNMENT>(p, bytes + (bytes == 0));
+		}
+
+		void * do_reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment) override
+		{
+			if( _isOverAligned(alignment) )
+				return realloc_memory_resource::do_reallocate(p, oldBytes, newBytes, alignment);
+			else
+				return oel::_detail::AllocAndHandleFail<_realloc, false>(newBytes + (newBytes == 0), p);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+}
+
+inline realloc_memory_resource * malloc_resource() noexcept
+{
+	static _detail::MallocResource res;
+	return &res;
+}
+
+
+inline void * monotonic_realloc_resource::do_allocate(size_t const bytes, size_t const alignment)
+{
+	return _bump.allocate(bytes, alignment, [this](size_t size) { return _upstream->allocate(size, alignof(_chunkHeader)); });
+}
+
+inline void monotonic_realloc_resource::do_deallocate(void * p, size_t bytes, size_t)
+{
+	_bump.deallocate(p, bytes);
+}
+
+inline void * monotonic_realloc_resource::do_reallocate(void * p, size_t oldBytes, size_t newBytes, size_t alignment)
+{
+	if( _bump.resizeLast(p, oldBytes, newBytes) )
+		return p;
+
+	return realloc_memory_resource::do_reallocate(p, oldBytes, newBytes, alignment);
+}
+
+inline void monotonic_realloc_resource::release() noexcept
+{
+	_bump.rewind(nullptr, nullptr, [this](_chunkHeader * c) { _upstream->deallocate(c, c->size, alignof(_chunkHeader)); });
+}
+
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "allocator.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+/** @file
+*/
+
+namespace oel
+{
+
+//! Largest block in bytes that pool_allocator takes from its pool, bigger blocks come from malloc
+inline constexpr size_t pool_max_bytes = 4096;
+
+//! Allocator with per-thread caches of small blocks in power of two size classes, for many small containers
+/**
+* Blocks up to pool_max_bytes come from the cache of the calling thread without any locking. The size classes
+* 16, 32, ..., 4096 bytes match the doubling of capacity that dynarray does by default, and allocate_at_least
+* reports the whole class as usable, so growing by one element from an empty dynarray always fills a class.
+* Larger blocks and over-aligned T are handled by oel::allocator.
+*
+* A block may be deallocated by any thread. If it is not the thread that allocated it, the block is put on
+* a lock-free list that the owning thread takes back when it runs out of blocks of some class.
+*
+* Memory for the small blocks is never returned to malloc. When a thread exits, its cache is kept for
+* the next thread that starts using the pool, so memory use is bounded by the peak number of threads. */
+template< typename T >
+class pool_allocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_move_assignment = std::true_type;
+
+	static constexpr bool   can_reallocate() noexcept { return is_trivially_relocatable<T>::value; }
+
+	static constexpr size_t max_size() noexcept       { return allocator<T>::max_size(); }
+
+	static T *  allocate(size_t count)                { return allocate_at_least(count).ptr; }
+	//! For a pooled block, the count of the result fills the size class
+	static allocation_result<T *> allocate_at_least(size_t count);
+
+	//! Returns the same pointer without copying if the new count fits in the size class of the block
+	/** oldCount must be a count that the block was allocated with. */
+	static allocation_result<T *> reallocate_at_least(T * ptr, size_t oldCount, size_t newCount);
+
+	static void deallocate(T * ptr, size_t count) noexcept;
+
+	pool_allocator() = default;
+
+	template< typename U >  OEL_ALWAYS_INLINE
+	constexpr pool_allocator(pool_allocator<U>) noexcept {}
+
+	friend constexpr bool operator==(pool_allocator, pool_allocator) noexcept  { return true; }
+	friend constexpr bool operator!=(pool_allocator, pool_allocator) noexcept  { return false; }
+
+private:
+	static constexpr bool _isPooled(size_t count) noexcept;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+namespace _detail
+{
+	struct PoolBlock
+	{
+		PoolBlock * next;
+	};
+
+	class PoolCache;
+
+	// Each slab holds blocks of one size class, and is aligned to its size so the header can be found from a block
+	struct alignas(64) PoolSlabHeader
+	{
+		PoolCache * owner;
+		unsigned    sizeClass;
+	};
+
+	inline constexpr size_t poolMinBytes   = 16;
+	inline constexpr size_t poolNClasses   = 9;
+	inline constexpr size_t poolSlabSize   = size_t{1} << 16;
+	inline constexpr size_t poolSlabsPerAllocation = 16;
+
+	static_assert(poolMinBytes << (poolNClasses - 1) == pool_max_bytes);
+
+	constexpr unsigned PoolSizeClass(size_t const nBytes) noexcept
+	{
+		unsigned c{};
+		while( (poolMinBytes << c) < nBytes )
+			++c;
+		return c;
+	}
+
+	constexpr size_t PoolClassBytes(unsigned const sizeClass) noexcept
+	{
+		return poolMinBytes << sizeClass;
+	}
+
+	inline PoolSlabHeader * PoolSlabOf(void *const block) noexcept
+	{
+		auto const i = reinterpret_cast<std::uintptr_t>(block) & ~(poolSlabSize - 1);
+		return reinterpret_cast<PoolSlabHeader *>(i);
+	}
+
+	class PoolCache
+	{
+	public:
+		void * pop(unsigned const c)
+		{
+			if( auto b = _free[c] )
+			{
+				_free[c] = b->next;
+				return b;
+			}
+			return _popSlow(c);
+		}
+
+		void push(void *const p, unsigned const c) noexcept
+		{
+			auto const b = static_cast<PoolBlock *>(p);
+			b->next = _free[c];
+			_free[c] = b;
+		}
+
+		void pushRemote(void *const p) noexcept
+		{
+			auto const b = static_cast<PoolBlock *>(p);
+			b->next = _remote.load(std::memory_order_relaxed);
+			while( !_remote.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed) )
+			{}
+		}
+
+		// Returns a cache orphaned by an exited thread, or a new one
+		static PoolCache * adopt()
+		{
+			{	std::lock_guard<std::mutex> lock{_orphanMutex()};
+				if( auto c = _orphans() )
+				{
+					_orphans() = c->_nextOrphan;
+					return c;
+				}
+			}
+			return new PoolCache{};
+		}
+
+		static void orphan(PoolCache *const c) noexcept
+		{
+			std::lock_guard<std::mutex> lock{_orphanMutex()};
+			c->_nextOrphan = _orphans();
+			_orphans() = c;
+		}
+
+		// Used after the thread's own cache is destroyed, must be locked with sharedMutex
+		static PoolCache & shared() noexcept
+		{
+			static PoolCache c;
+			return c;
+		}
+
+		static std::mutex & sharedMutex() noexcept
+		{
+			static std::mutex m;
+			return m;
+		}
+
+	private:
+		PoolBlock * _free[poolNClasses]{};
+		std::byte * _bump[poolNClasses]{};
+		std::byte * _bumpEnd[poolNClasses]{};
+		std::byte * _slabs{};
+		std::byte * _slabsEnd{};
+		std::atomic<PoolBlock *> _remote{};
+		PoolCache * _nextOrphan{};
+
+		static PoolCache *& _orphans() noexcept
+		{
+			static PoolCache * head;
+			return head;
+		}
+
+		static std::mutex & _orphanMutex() noexcept
+		{
+			static std::mutex m;
+			return m;
+		}
+
+		void * _popSlow(unsigned const c)
+		{
+			auto const size = PoolClassBytes(c);
+			if( _bump[c] != _bumpEnd[c] )
+			{
+				auto const p = _bump[c];
+				_bump[c] += size;
+				return p;
+			}
+			if( _drainRemote() )
+			{
+				if( auto b = _free[c] )
+				{
+					_free[c] = b->next;
+					return b;
+				}
+			}
+			auto const slab = _newSlab();
+			::new(slab) PoolSlabHeader{this, c};
+
+			auto const first = slab + (size > sizeof(PoolSlabHeader) ? size : sizeof(PoolSlabHeader));
+			_bump[c]    = first + size;
+			_bumpEnd[c] = slab + poolSlabSize / size * size;
+			return first;
+		}
+
+		bool _drainRemote() noexcept
+		{
+			auto b = _remote.exchange(nullptr, std::memory_order_acquire);
+			bool const any = b;
+			while( b )
+			{
+				auto const next = b->next;
+				push(b, PoolSlabOf(b)->sizeClass);
+				b = next;
+			}
+			return any;
+		}
+
+		std::byte * _newSlab()
+		{
+			if( _slabs == _slabsEnd )
+			{
+				constexpr auto n = poolSlabSize * poolSlabsPerAllocation;
+				_slabs = static_cast<std::byte *>( AllocAndHandleFail< Malloc<poolSlabSize> >(n) );
+				_slabsEnd = _slabs + n;
+			}
+			auto const s = _slabs;
+			_slabs += poolSlabSize;
+			return s;
+		}
+	};
+
+	inline thread_local bool poolThreadDone;
+	// Set while the cache of this thread exists, so that deallocate can check without creating it
+	inline thread_local PoolCache * poolThreadCache;
+
+	struct PoolThreadCache
+	{
+		PoolCache *const cache = PoolCache::adopt();
+
+		PoolThreadCache()  { poolThreadCache = cache; }
+
+		~PoolThreadCache()
+		{
+			poolThreadCache = nullptr;
+			PoolCache::orphan(cache);
+			poolThreadDone = true;
+		}
+	};
+
+	// Returns null if called during destruction of thread_local objects, after the cache was destroyed
+	inline PoolCache * CurrentPoolCache()
+	{
+		if( poolThreadDone )
+			return nullptr;
+
+		static thread_local PoolThreadCache tc;
+		return tc.cache;
+	}
+
+	inline void * PoolAllocate(unsigned const sizeClass)
+	{
+		if( auto c = CurrentPoolCache() )
+			return c->pop(sizeClass);
+
+		std::lock_guard<std::mutex> lock{PoolCache::sharedMutex()};
+		return PoolCache::shared().pop(sizeClass);
+	}
+
+	inline void PoolDeallocate(void *const p) noexcept
+	{
+		auto const slab = PoolSlabOf(p);
+		// Never creates the cache of this thread, as that can throw. The owner takes back remote blocks anyway
+		if( slab->owner == poolThreadCache )
+			slab->owner->push(p, slab->sizeClass);
+		else
+			slab->owner->pushRemote(p);
+	}
+}
+
+template< typename T >
+constexpr bool pool_allocator<T>::_isPooled(size_t const count) noexcept
+{
+	return alignof(T) <= OEL_MALLOC_ALIGNMENT and sizeof(T) * count <= pool_max_bytes;
+}
+
+template< typename T >
+allocation_result<T *> pool_allocator<T>::allocate_at_least(size_t const count)
+{
+	if( _isPooled(count) )
+	{
+		auto const c = _detail::PoolSizeClass(sizeof(T) * count);
+		return {static_cast<T *>( _detail::PoolAllocate(c) ), _detail::PoolClassBytes(c) / sizeof(T)};
+	}
+	else
+	{	return allocator<T>::allocate_at_least(count);
+	}
+}
+
+template< typename T >
+allocation_result<T *> pool_allocator<T>::reallocate_at_least(T *const ptr, size_t const oldCount, size_t const newCount)
+{
+	OEL_ASSERT(0 < newCount and newCount <= max_size());
+
+	if( !ptr )
+		return allocate_at_least(newCount);
+
+	bool const wasPooled = _isPooled(oldCount);
+	if( wasPooled and _isPooled(newCount) )
+	{
+		auto const c = _detail::PoolSizeClass(sizeof(T) * oldCount);
+		if( c == _detail::PoolSizeClass(sizeof(T) * newCount) )
+			return {ptr, _detail::PoolClassBytes(c) / sizeof(T)};
+	}
+	else if( !wasPooled and !_isPooled(newCount) )
+	{
+		return allocator<T>::reallocate_at_least(ptr, newCount);
+	}
+	auto const r = allocate_at_least(newCount);
+	auto const n = oldCount < newCount ? oldCount : newCount;
+	std::memcpy(static_cast<void *>(r.ptr), static_cast<const void *>(ptr), sizeof(T) * n);
+	deallocate(ptr, oldCount);
+	return r;
+}
+
+template< typename T >
+inline void pool_allocator<T>::deallocate(T *const ptr, size_t const count) noexcept
+{
+	if( _isPooled(count) )
+	{
+		if( ptr )
+			_detail::PoolDeallocate(ptr);
+	}
+	else
+	{	allocator<T>::deallocate(ptr, count);
+	}
+}
+
+} // namespace oel
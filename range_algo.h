@@ -9,11 +9,12 @@
 #include "dynarray.h"
 #include "util.h"  // for as_unsigned
 #include "auxi/range_algo_detail.h"
+#include "auxi/simd_compress.h"
 #include "view/counted.h"
 
 
 /** @file
-* @brief Efficient range-based erase, copy functions and concat_to_dynarray
+* @brief Efficient range-based erase, copy functions, append_if and concat_to_dynarray
 *
 * Designed to interface with the standard library.
 */
@@ -77,12 +78,52 @@ constexpr void unordered_erase(RandomAccessContainer & c, Integer index)
 template< typename Integer, typename T, typename A >  inline
 void unordered_erase(dynarray<T, A> & d, Integer index)  { d.unordered_erase(d.begin() + index); }
 
+//! Predicate that returns `comp(x, value)` for argument x, recognized by erase_if and append_if
+/**
+* If Compare is one of std::less, less_equal, greater, greater_equal, equal_to, not_equal_to (with void or the
+* element type as template argument), and both the elements and value are the same arithmetic type of 4 or 8 bytes,
+* then erase_if and append_if on a dynarray do the filtering with SIMD instructions where available. Example:
+@code
+oel::erase_if(floats, oel::compare_with{std::less<>{}, 0.f}); // erase negative
+@endcode  */
+template< typename Compare, typename T >
+struct compare_with
+{
+	Compare comp;
+	T       value;
+
+	template< typename U >
+	constexpr bool operator()(const U & x) const   { return comp(x, value); }
+};
+
+template< typename Compare, typename T >
+compare_with(Compare, T) -> compare_with<Compare, T>;
+
+namespace _detail
+{
+	template< typename UnaryPred >
+	inline constexpr bool isCompareWith = false;
+
+	template< typename Compare, typename T >
+	inline constexpr bool isCompareWith< compare_with<Compare, T> > = true;
+}
+
 /**
 * @brief Erase from container all elements for which predicate returns true
 *
 * This mimics `std::erase_if` (C++20) for sequence containers  */
 template< typename Container, typename UnaryPredicate >
 constexpr void erase_if(Container & c, UnaryPredicate p)   { _detail::RemoveIf(c, std::move(p)); }
+//! Uses AVX2 or AVX-512 compaction if possible, see compare_with
+template< typename T, typename A, typename Compare, typename U >
+void erase_if(dynarray<T, A> & d, compare_with<Compare, U> p);
+
+//! Append the elements of source for which p returns true to dest
+/**
+* With a sized, contiguous source of T and p of type compare_with, the filtering is done with SIMD instructions
+* where available, see compare_with. Then dest is first grown to have room for all source elements. */
+template< typename T, typename A, typename InputRange, typename UnaryPredicate >
+void append_if(dynarray<T, A> & dest, InputRange && source, UnaryPredicate p);
 /**
 * @brief Erase consecutive duplicate elements in container
 *
@@ -130,6 +171,48 @@ auto copy_fit(InputRange && source, RandomAccessRange && dest)
 // Just implementation
 
 
+template< typename T, typename A, typename Compare, typename U >
+void oel::erase_if(dynarray<T, A> & d, compare_with<Compare, U> p)
+{
+	if constexpr( _detail::canCompressCmp<T, Compare, U> )
+	{
+		constexpr auto op = _detail::CmpOpOf<T, Compare>();
+		auto const n = _detail::CompressCmp<op>(d.data(), d.size(), d.data(), p.value, false);
+		d.erase_to_end(d.begin() + n);
+	}
+	else
+	{	_detail::RemoveIf(d, std::move(p));
+	}
+}
+
+template< typename T, typename A, typename InputRange, typename UnaryPredicate >
+void oel::append_if(dynarray<T, A> & dest, InputRange && source, UnaryPredicate p)
+{
+	using Iter = iterator_t<InputRange>;
+	if constexpr( _detail::isCompareWith<UnaryPredicate> and can_memmove_with<T *, Iter> and range_is_sized<InputRange> )
+	{
+		using Compare = decltype(p.comp);
+		using U       = decltype(p.value);
+		if constexpr( _detail::canCompressCmp<T, Compare, U> )
+		{
+			constexpr auto op = _detail::CmpOpOf<T, Compare>();
+			auto const n   = as_unsigned(_detail::Size(source));
+			auto const src = to_pointer_contiguous(oel::begin_(source));
+			dest.append_and_overwrite(
+				n,
+				[src, &p](T * out, size_t n_) { return _detail::CompressCmp<op>(src, n_, out, p.value, true); } );
+			return;
+		}
+	}
+	auto it = oel::begin_(source);
+	auto l  = oel::end_(source);
+	for( ; it != l; ++it )
+	{
+		if( p(*it) )
+			dest.emplace_back(*it);
+	}
+}
+
 template< typename InputRange, typename RandomAccessRange >
 auto oel::copy_fit(InputRange && source, RandomAccessRange && dest)
 ->	copy_return< borrowed_iterator_t<InputRange> >
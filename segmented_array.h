@@ -0,0 +1,465 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "dynarray.h"
+
+#include <climits>
+#if defined _MSC_VER and !defined __clang__
+#include <intrin.h>
+#endif
+
+/** @file
+*/
+
+namespace oel
+{
+namespace _detail
+{
+	// Index of the highest set bit, x must be non-zero
+	inline unsigned HighBitIndex(size_t x) noexcept
+	{
+	#if defined __GNUC__ or defined __clang__
+		return 63u - static_cast<unsigned>( __builtin_clzll(x) );
+	#elif defined _MSC_VER and defined _WIN64
+		unsigned long i;
+		_BitScanReverse64(&i, x);
+		return i;
+	#else
+		unsigned i{};
+		while( x >>= 1 )
+			++i;
+		return i;
+	#endif
+	}
+
+	// First block is 16 elements or 256 bytes, whichever is greater, rounded up to power of two
+	constexpr unsigned SegmentFirstShift(size_t elemSize)
+	{
+		unsigned s = 4;
+		while( (size_t{1} << s) * elemSize < 256 )
+			++s;
+		return s;
+	}
+
+	struct SegmentPos
+	{
+		size_t block;
+		size_t offset;
+	};
+
+	// Block k holds 2^(FirstShift + k) elements, and starts at index 2^(FirstShift + k) - 2^FirstShift
+	template< unsigned FirstShift >
+	OEL_ALWAYS_INLINE inline SegmentPos SegmentLocate(size_t const index) noexcept
+	{
+		auto const j = index + (size_t{1} << FirstShift);
+		auto const k = _detail::HighBitIndex(j) - FirstShift;
+		return {k, j - (size_t{1} << (FirstShift + k))};
+	}
+
+	template< typename T, unsigned FirstShift >
+	struct SegmentIter
+	{
+		using iterator_category = std::random_access_iterator_tag;
+
+		using difference_type = ptrdiff_t;
+		using value_type      = std::remove_const_t<T>;
+		using pointer         = T *;
+		using reference       = T &;
+
+		using const_type = SegmentIter<const T, FirstShift>;
+
+		operator const_type() const noexcept  { return {_blocks, _index}; }
+
+		reference operator*() const noexcept
+			{
+				auto const p = _detail::SegmentLocate<FirstShift>(_index);
+				return _blocks[p.block][p.offset];
+			}
+
+		pointer operator->() const noexcept  { return &**this; }
+
+		reference operator[](difference_type offset) const noexcept  { return *(*this + offset); }
+
+		SegmentIter & operator++() & noexcept  { ++_index;  return *this; }
+		SegmentIter & operator--() & noexcept  { --_index;  return *this; }
+
+		SegmentIter operator++(int) & noexcept  { auto tmp = *this;  ++_index;  return tmp; }
+		SegmentIter operator--(int) & noexcept  { auto tmp = *this;  --_index;  return tmp; }
+
+		SegmentIter & operator+=(difference_type offset) & noexcept  { _index += offset;  return *this; }
+		SegmentIter & operator-=(difference_type offset) & noexcept  { _index -= offset;  return *this; }
+
+		friend SegmentIter operator +(SegmentIter it, difference_type offset) noexcept  { return it += offset; }
+		friend SegmentIter operator +(difference_type offset, SegmentIter it) noexcept  { return it += offset; }
+		friend SegmentIter operator -(SegmentIter it, difference_type offset) noexcept  { return it -= offset; }
+
+		friend difference_type operator -(const SegmentIter & left, const SegmentIter & right) noexcept
+			{
+				return static_cast<difference_type>(left._index - right._index);
+			}
+
+		friend bool operator==(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index == right._index; }
+		friend bool operator!=(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index != right._index; }
+		friend bool operator <(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index < right._index; }
+		friend bool operator >(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index > right._index; }
+		friend bool operator<=(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index <= right._index; }
+		friend bool operator>=(const SegmentIter & left, const SegmentIter & right) noexcept  { return left._index >= right._index; }
+
+		std::remove_const_t<T> * const * _blocks;
+		size_t _index;
+	};
+}
+
+
+//! Resizable array that never moves its elements, made of blocks that double in size
+/**
+* Pointers and references to elements stay valid until the element is erased. Iterators are invalidated
+* when a block is added, like with std::deque. Element access is a few instructions more than dynarray,
+* while appending never copies or relocates. T needs neither be trivially relocatable nor movable.
+*
+* Blocks are allocated with Alloc, while the list of blocks is a dynarray with the default allocator.
+* For contiguous, trivially copyable sources, append_range copies with memcpy per block. */
+template< typename T, typename Alloc = allocator<> >
+class segmented_array
+{
+	using _alloTrait = typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+	static constexpr auto _firstShift = _detail::SegmentFirstShift(sizeof(T));
+
+public:
+	using value_type      = T;
+	using allocator_type  = typename _alloTrait::allocator_type;
+	using difference_type = ptrdiff_t;
+	using size_type       = size_t;
+
+	using iterator       = _detail::SegmentIter<T, _firstShift>;
+	using const_iterator = _detail::SegmentIter<const T, _firstShift>;
+
+	segmented_array() noexcept(noexcept( Alloc{} ))  : segmented_array(Alloc{}) {}
+	explicit segmented_array(Alloc a) noexcept       : _m(a) {}
+
+	template< typename InputRange >
+	segmented_array(from_range_t, InputRange && r, Alloc a = Alloc{})   : segmented_array(a) { append_range(r); }
+
+	segmented_array(std::initializer_list<T> il, Alloc a = Alloc{})     : segmented_array(a) { append_range(il); }
+
+	segmented_array(segmented_array && other) noexcept
+	 :	_m(std::move(other._m))
+	{
+		other._resetEmpty();
+	}
+	explicit segmented_array(const segmented_array & other)
+	 :	segmented_array( _alloTrait::select_on_container_copy_construction(other.get_allocator()) )
+	{
+		append_range(other);
+	}
+
+	~segmented_array()   { _destroyAll(); }
+
+	//! Requires that allocators are always equal or propagate_on_container_move_assignment is true
+	segmented_array & operator =(segmented_array && other) & noexcept;
+	segmented_array & operator =(const segmented_array & other) &
+		{
+			if( this != &other )
+			{
+				clear();
+				append_range(other);
+			}
+			return *this;
+		}
+
+	//! If an exception is thrown, the elements already appended during the operation are kept
+	template< typename InputRange = std::initializer_list<T> >
+	void append_range(InputRange && source);
+
+	template< typename... Args >
+	T &  emplace_back(Args &&... args) &
+		{
+			if( _m.end == _m.blockEnd )
+				_nextBlock();
+
+			_alloTrait::construct(_m, _m.end, static_cast<Args &&>(args)...);
+			++_m.size;
+			return *(_m.end++);
+		}
+
+	void push_back(T && val)       { emplace_back(std::move(val)); }
+	void push_back(const T & val)  { emplace_back(val); }
+
+	void pop_back() noexcept
+		{
+			OEL_ASSERT(_m.size > 0);
+			(*this)[_m.size - 1].~T();
+			--_m.size;
+			_updateEnd();
+		}
+
+	//! Value-initializes added elements
+	void resize(size_type n);
+
+	void clear() noexcept   { _destroyFrom(0); }
+
+	//! Allocates blocks until capacity is at least minCap
+	void reserve(size_type minCap);
+	//! Deallocates blocks that hold no elements
+	void shrink_to_fit() noexcept;
+
+	[[nodiscard]] bool empty() const noexcept  { return _m.size == 0; }
+
+	size_type size() const noexcept      { return _m.size; }
+
+	size_type capacity() const noexcept  { return _blockStart(_m.blocks.size()); }
+
+	allocator_type get_allocator() const noexcept   { return _m; }
+
+	iterator       begin() noexcept          { return {_m.blocks.data(), 0}; }
+	const_iterator begin() const noexcept    { return {_m.blocks.data(), 0}; }
+	const_iterator cbegin() const noexcept   { return begin(); }
+
+	iterator       end() noexcept          { return {_m.blocks.data(), _m.size}; }
+	const_iterator end() const noexcept    { return {_m.blocks.data(), _m.size}; }
+	const_iterator cend() const noexcept   { return end(); }
+
+	T &       front() noexcept        { return (*this)[0]; }
+	const T & front() const noexcept  { return (*this)[0]; }
+
+	T &       back() noexcept         { return (*this)[_m.size - 1]; }
+	const T & back() const noexcept   { return (*this)[_m.size - 1]; }
+
+	T &       operator[](size_type index) noexcept
+		{
+			OEL_ASSERT(index < _m.size);
+			auto const p = _detail::SegmentLocate<_firstShift>(index);
+			return _m.blocks.data()[p.block][p.offset];
+		}
+	const T & operator[](size_type index) const noexcept
+		{
+			OEL_ASSERT(index < _m.size);
+			auto const p = _detail::SegmentLocate<_firstShift>(index);
+			return _m.blocks.data()[p.block][p.offset];
+		}
+
+	T &       at(size_type index)
+		{
+			const auto & cSelf = *this;
+			return const_cast<T &>(cSelf.at(index));
+		}
+	const T & at(size_type index) const
+		{
+			if( index < _m.size )
+				return (*this)[index];
+			else
+				_detail::OutOfRange::raise();
+		}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	using _usedAlloc_7KQw = allocator_type; // guarding against name collision due to inheritance (MSVC)
+
+	struct _members : public _usedAlloc_7KQw
+	{
+		dynarray<T *> blocks;
+		size_type     size{};
+		T *           end{};      // where the next element goes, or equal to blockEnd if capacity is full
+		T *           blockEnd{};
+
+		_members(_usedAlloc_7KQw a) noexcept
+		 :	_usedAlloc_7KQw(std::move(a))
+		{}
+	}
+	_m;
+
+
+	static constexpr size_type _blockSize(size_type k)   { return size_type{1} << (_firstShift + k); }
+
+	static constexpr size_type _blockStart(size_type k)  { return _blockSize(k) - _blockSize(0); }
+
+	void _resetEmpty() noexcept
+	{
+		_m.size = 0;
+		_m.end = _m.blockEnd = nullptr;
+	}
+
+	void _addBlock()
+	{
+		auto const k = _m.blocks.size();
+		if( k + _firstShift >= sizeof(size_type) * CHAR_BIT - 1 )
+			_detail::LengthError::raise();
+
+		_m.blocks.reserve(k + 1); // so that push_back cannot throw after allocating
+		_m.blocks.push_back( _alloTrait::allocate(_m, _blockSize(k)) );
+	}
+
+	// Sets _m.end and _m.blockEnd from _m.size
+	void _updateEnd() noexcept
+	{
+		auto const p = _detail::SegmentLocate<_firstShift>(_m.size);
+		if( p.block < _m.blocks.size() )
+		{
+			T *const b = _m.blocks[p.block];
+			_m.end      = b + p.offset;
+			_m.blockEnd = b + _blockSize(p.block);
+		}
+		else
+		{	_m.end = _m.blockEnd = nullptr;
+		}
+	}
+
+	void _nextBlock()
+	{
+		if( capacity() == _m.size )
+			_addBlock();
+
+		_updateEnd();
+	}
+
+	// Calls f(first, count) for each contiguous part of the n elements after end, which must be within capacity.
+	// f must construct all count elements or throw after destroying any it constructed
+	template< typename Func >
+	void _forEachSpare(size_type n, Func f)
+	{
+		struct Guard
+		{
+			segmented_array & self;
+			~Guard() { self._updateEnd(); }
+		}
+		g{*this};
+
+		while( n > 0 )
+		{
+			auto const p = _detail::SegmentLocate<_firstShift>(_m.size);
+			auto const room = _blockSize(p.block) - p.offset;
+			auto const count = n < room ? n : room;
+
+			f(_m.blocks[p.block] + p.offset, count);
+			_m.size += count;
+			n     -= count;
+		}
+	}
+
+	void _destroyFrom(size_type const newSize) noexcept
+	{
+		if constexpr( !std::is_trivially_destructible_v<T> )
+		{
+			while( _m.size > newSize )
+			{
+				auto const p = _detail::SegmentLocate<_firstShift>(--_m.size);
+				_m.blocks[p.block][p.offset].~T();
+			}
+		}
+		_m.size = newSize;
+		_updateEnd();
+	}
+
+	void _destroyAll() noexcept
+	{
+		_destroyFrom(0);
+		for( size_type k{}; k < _m.blocks.size(); ++k )
+		{
+			_alloTrait::deallocate(_m, _m.blocks[k], _blockSize(k));
+		}
+		_m.blocks.clear();
+		_resetEmpty();
+	}
+};
+
+template< typename T, typename Alloc >
+segmented_array<T, Alloc> & segmented_array<T, Alloc>::operator =(segmented_array && other) & noexcept
+{
+	static_assert( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value );
+
+	if( this != &other )
+	{
+		_destroyAll();
+		if constexpr( _alloTrait::propagate_on_container_move_assignment::value )
+		{
+			allocator_type & a = _m;
+			a = static_cast<allocator_type &&>(other._m);
+		}
+		_m.blocks   = std::move(other._m.blocks);
+		_m.size     = other._m.size;
+		_m.end      = other._m.end;
+		_m.blockEnd = other._m.blockEnd;
+		other._resetEmpty();
+	}
+	return *this;
+}
+
+template< typename T, typename Alloc >
+template< typename InputRange >
+void segmented_array<T, Alloc>::append_range(InputRange && source)
+{
+	auto it = oel::begin_(source);
+	if constexpr( _detail::rangeIsForwardOrSized<InputRange> )
+	{
+		auto const n = _detail::UDist(source);
+		reserve(_m.size + n);
+		if constexpr( can_memmove_with<T *, decltype(it)> )
+		{
+			_forEachSpare(n, [&it](T * dest, size_type count)
+			{
+				_detail::MemcpyCheck(it, count, dest);
+				it += count;
+			});
+			return;
+		}
+	}
+	auto const l = oel::end_(source);
+	for( ; it != l; ++it )
+		emplace_back(*it);
+}
+
+template< typename T, typename Alloc >
+void segmented_array<T, Alloc>::resize(size_type const n)
+{
+	if( n < _m.size )
+	{
+		_destroyFrom(n);
+	}
+	else
+	{	reserve(n);
+		allocator_type & a = _m;
+		_forEachSpare(n - _m.size, [&a](T * dest, size_type count)
+		{
+			_detail::ValueInit::call(dest, dest + count, a);
+		});
+	}
+}
+
+template< typename T, typename Alloc >
+void segmented_array<T, Alloc>::reserve(size_type const minCap)
+{
+	if( capacity() < minCap )
+	{
+		while( capacity() < minCap )
+			_addBlock();
+
+		_updateEnd();
+	}
+}
+
+template< typename T, typename Alloc >
+void segmented_array<T, Alloc>::shrink_to_fit() noexcept
+{
+	auto const used = _m.size > 0 ? _detail::SegmentLocate<_firstShift>(_m.size - 1).block + 1 : 0;
+	while( _m.blocks.size() > used )
+	{
+		auto const k = _m.blocks.size() - 1;
+		_alloTrait::deallocate(_m, _m.blocks[k], _blockSize(k));
+		_m.blocks.pop_back();
+	}
+	_updateEnd();
+}
+
+} // namespace oel
@@ -0,0 +1,423 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "auxi/dynarray_lease.h"
+
+/** @file
+*/
+
+namespace oel
+{
+namespace _detail
+{
+	// Used by small_dynarray. Treats the inline buffer as a block that was already allocated
+	template< typename T, typename Alloc >
+	struct InlineBufAlloc
+	{
+		using value_type = T;
+
+		Alloc  innerAlloc;
+		void * inlineBuf; // start of the inline buffer, including any space for DebugAllocationHeader
+
+		static constexpr bool can_reallocate() noexcept  { return allocator_can_realloc<Alloc>(); }
+
+		size_t max_size() const noexcept   { return std::allocator_traits<Alloc>::max_size(innerAlloc); }
+
+		T * allocate(size_t n)   { return std::allocator_traits<Alloc>::allocate(innerAlloc, n); }
+
+		allocation_result<T *> allocate_at_least(size_t n)   { return _detail::AllocateAtLeast(innerAlloc, n); }
+
+		// Only if Alloc has it, so that dynarray knows whether zeroed memory is cheap
+		template< typename A = Alloc >
+		auto allocate_zeroed(size_t n)
+		->	decltype( std::declval<A &>().allocate_zeroed(n) )
+		{	return    innerAlloc.allocate_zeroed(n); }
+
+		allocation_result<T *> reallocate_at_least(T * p, size_t oldN, size_t n)
+		{
+			if( p != inlineBuf )
+				return _detail::ReallocAtLeast(innerAlloc, p, oldN, n);
+
+			auto const r = allocate_at_least(n);
+			std::memcpy(static_cast<void *>(r.ptr), inlineBuf, sizeof(T) * (n < oldN ? n : oldN));
+			return r;
+		}
+
+		void deallocate(T * p, size_t n) noexcept
+		{
+			if( p != inlineBuf )
+				std::allocator_traits<Alloc>::deallocate(innerAlloc, p, n);
+		}
+
+		template< typename U, typename... Args >
+		void construct(U * p, Args &&... args)
+		{
+			std::allocator_traits<Alloc>::construct(innerAlloc, p, static_cast<Args &&>(args)...);
+		}
+
+		friend bool operator==(const InlineBufAlloc & x, const InlineBufAlloc & y)  { return x.innerAlloc == y.innerAlloc; }
+		friend bool operator!=(const InlineBufAlloc & x, const InlineBufAlloc & y)  { return x.innerAlloc != y.innerAlloc; }
+	};
+}
+
+
+//! Resizable array that stores up to N elements inside the object, only allocating when it grows beyond that
+/**
+* Has the same interface as dynarray, and shares its implementation of growth, relocation, insert and append.
+* Only differences are documented.
+*
+* Iterators are plain pointers, even when OEL_MEM_BOUND_DEBUG_LVL is non-zero. Unlike dynarray, a small_dynarray
+* is not trivially relocatable, and a move from one that is using inline storage relocates the elements.
+* The move constructor and move assignment require that T is trivially relocatable or noexcept move constructible. */
+template< typename T, size_t N, typename Alloc = allocator<> >
+class small_dynarray
+{
+	using _alloTrait = typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+public:
+	static_assert(N > 0);
+
+	using value_type      = T;
+	using allocator_type  = typename _alloTrait::allocator_type;
+	using difference_type = ptrdiff_t;
+	using size_type       = size_t;
+
+	using iterator       = T *;
+	using const_iterator = const T *;
+
+	small_dynarray() noexcept(noexcept( Alloc{} ))  : small_dynarray(Alloc{}) {}
+	explicit small_dynarray(Alloc a) noexcept       : _m(a) { _initInline(); }
+
+	//! Construct empty small_dynarray with space reserved for at least capacity elements
+	small_dynarray(reserve_tag, size_type capacity, Alloc a = Alloc{})   : small_dynarray(a) { reserve(capacity); }
+
+	//! @copydoc dynarray::dynarray(size_type, for_overwrite_t, Alloc)
+	small_dynarray(size_type size, for_overwrite_t, Alloc a = Alloc{})   : small_dynarray(a) { resize_for_overwrite(size); }
+	//! (Value-initializes elements, same as std::vector)
+	explicit small_dynarray(size_type size, Alloc a = Alloc{})           : small_dynarray(a) { resize(size); }
+
+	template< typename InputRange >
+	small_dynarray(from_range_t, InputRange && r, Alloc a = Alloc{})   : small_dynarray(a) { append_range(r); }
+
+	small_dynarray(std::initializer_list<T> il, Alloc a = Alloc{})     : small_dynarray(a) { append_range(il); }
+
+	small_dynarray(small_dynarray && other) noexcept
+	 :	_m(static_cast<allocator_type &>(other._m))
+	{
+		_initInline();
+		_moveFrom(other);
+	}
+	explicit small_dynarray(const small_dynarray & other)
+	 :	small_dynarray( _alloTrait::select_on_container_copy_construction(other._m) ) { append_range(other); }
+
+	~small_dynarray()
+	{
+		_detail::Destroy(_m.data, _m.end);
+		_freeHeap();
+	}
+
+	small_dynarray & operator =(small_dynarray && other) &
+		noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value );
+	small_dynarray & operator =(const small_dynarray & other) &
+		{
+			if( this != &other )
+				assign_range(other);
+
+			return *this;
+		}
+	small_dynarray & operator =(const small_dynarray &&) = delete;
+
+	small_dynarray & operator =(std::initializer_list<T> il) &  { assign_range(il);  return *this; }
+
+	template< typename InputRange >
+	void assign_range(InputRange && source)   { _lease()->assign_range(source); }
+
+	template< typename InputRange = std::initializer_list<T> >
+	void append_range(InputRange && source)   { _lease()->append_range(source); }
+
+	void resize_for_overwrite(size_type n)    { _lease()->resize_for_overwrite(n); }
+	void resize(size_type n)                  { _lease()->resize(n); }
+
+	template< typename Range >
+	iterator insert_range(const_iterator pos, Range && source) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->insert_range(l.iter(pos), source) );
+		}
+
+	iterator insert(const_iterator pos, T && val) &       { return emplace(pos, std::move(val)); }
+	iterator insert(const_iterator pos, const T & val) &  { return emplace(pos, val); }
+
+	template< typename... Args >
+	iterator emplace(const_iterator pos, Args &&... args) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->emplace(l.iter(pos), static_cast<Args &&>(args)...) );
+		}
+
+	template< typename... Args >
+	T &  emplace_back(Args &&... args) &
+		{
+			if( _m.end < _m.reservEnd )
+			{	// Skipping the lease for the common case
+				_alloTrait::construct(_m, _m.end, static_cast<Args &&>(args)...);
+				_detail::DebugSizeInHeaderUpdater<_internBase> guard{_m};
+				return *(_m.end++);
+			}
+			return _lease()->emplace_back(static_cast<Args &&>(args)...);
+		}
+
+	void push_back(T && val)       { emplace_back(std::move(val)); }
+	void push_back(const T & val)  { emplace_back(val); }
+
+	void pop_back() noexcept
+		{
+			OEL_ASSERT(_m.data < _m.end);
+			--_m.end;
+			_m.end-> ~T();
+		}
+
+	void     unordered_erase(iterator pos)
+		{
+			auto l = _lease();
+			l->unordered_erase(l.iter(pos));
+		}
+
+	iterator erase(const_iterator pos) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(pos)) );
+		}
+
+	iterator erase(const_iterator first, const_iterator last) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(first), l.iter(last)) );
+		}
+
+	void     erase_to_end(const_iterator first) noexcept
+		{
+			auto const newEnd = const_cast<T *>(first);
+			OEL_ASSERT(_m.data <= newEnd and newEnd <= _m.end);
+
+			_detail::Destroy(newEnd, _m.end);
+			_m.end = newEnd;
+		}
+
+	void     clear() noexcept   { erase_to_end(_m.data); }
+
+	void     reserve(size_type minCap)
+		{
+			if( capacity() < minCap )
+				_lease()->reserve(minCap);
+		}
+	//! Moves the elements back to inline storage if size() <= N
+	void     shrink_to_fit();
+
+	//! Returns true if the elements are stored inside this object, false if in allocated memory
+	bool     is_inline() const noexcept   { return _m.data == _inlineData(); }
+
+	[[nodiscard]] bool empty() const noexcept  { return _m.data == _m.end; }
+
+	size_type size() const noexcept            { return static_cast<size_t>(_m.end - _m.data); }
+
+	size_type capacity() const noexcept        { return static_cast<size_t>(_m.reservEnd - _m.data); }
+
+	static constexpr size_type inline_capacity() noexcept   { return N; }
+
+	size_type max_size() const noexcept   { return _alloTrait::max_size(_m) - _nHeader; }
+
+	allocator_type get_allocator() const noexcept   { return _m; }
+
+	iterator       begin() noexcept          { return _m.data; }
+	const_iterator begin() const noexcept    { return _m.data; }
+	const_iterator cbegin() const noexcept   { return _m.data; }
+
+	iterator       end() noexcept          { return _m.end; }
+	const_iterator end() const noexcept    { return _m.end; }
+	const_iterator cend() const noexcept   { return _m.end; }
+
+	auto      rbegin() noexcept         { return std::reverse_iterator{end()}; }
+	auto      rbegin() const noexcept   { return std::reverse_iterator{end()}; }
+	auto      crbegin() const noexcept  { return std::reverse_iterator{end()}; }
+
+	auto      rend() noexcept         { return std::reverse_iterator{begin()}; }
+	auto      rend() const noexcept   { return std::reverse_iterator{begin()}; }
+	auto      crend() const noexcept  { return std::reverse_iterator{begin()}; }
+
+	T *       data() noexcept         { return _m.data; }
+	const T * data() const noexcept   { return _m.data; }
+
+	T &       front() noexcept        { return (*this)[0]; }
+	const T & front() const noexcept  { return (*this)[0]; }
+
+	T &       back() noexcept         { return (*this)[size() - 1]; }
+	const T & back() const noexcept   { return (*this)[size() - 1]; }
+
+	T &       operator[](size_type index) noexcept        { OEL_ASSERT(index < size());  return _m.data[index]; }
+	const T & operator[](size_type index) const noexcept  { OEL_ASSERT(index < size());  return _m.data[index]; }
+
+	OEL_ALWAYS_INLINE
+	T &       at(size_type index)
+		{
+			const auto & cSelf = *this;
+			return const_cast<T &>(cSelf.at(index));
+		}
+	const T & at(size_type index) const
+		{
+			if( index < size() )
+				return _m.data[index];
+			else
+				_detail::OutOfRange::raise();
+		}
+
+	friend bool operator==(const small_dynarray & left, const small_dynarray & right)
+		{
+			return left.size() == right.size() and
+			       std::equal(left.begin(), left.end(), right.begin());
+		}
+	friend bool operator!=(const small_dynarray & left, const small_dynarray & right)  { return !(left == right); }
+
+	friend bool operator <(const small_dynarray & left, const small_dynarray & right)
+		{
+			return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+		}
+	friend bool operator >(const small_dynarray & left, const small_dynarray & right)  { return right < left; }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	using _allocateWrap = _detail::DebugAllocateWrapper<allocator_type, T *>;
+	using _internBase   = _detail::DynarrBase<T *>;
+	using _usedAlloc_7KQw = allocator_type; // guarding against name collision due to inheritance (MSVC)
+
+	static constexpr auto _nHeader = _allocateWrap::sizeForHeader;
+
+	using _leaseAlloc = _detail::InlineBufAlloc<T, allocator_type>;
+
+	struct _storage : _internBase, public _usedAlloc_7KQw
+	{
+		using B = ::oel::_detail::DynarrBase<value_type *>;
+
+		using B::data;
+		using B::end;
+		using B::reservEnd;
+
+		_storage(_usedAlloc_7KQw a) noexcept
+		 :	B{}, _usedAlloc_7KQw(std::move(a))
+		{}
+
+		B    load() const noexcept       { return *this; }
+		void store(const B & b) noexcept { static_cast<B &>(*this) = b; }
+	}
+	_m;
+
+	_detail::RelocateWrap<T> _buf[_nHeader + N];
+
+
+	T * _inlineData() noexcept              { return reinterpret_cast<T *>(_buf + _nHeader); }
+	const T * _inlineData() const noexcept  { return reinterpret_cast<const T *>(_buf + _nHeader); }
+
+	void _initInline() noexcept
+	{
+		_m.end = _m.data = _inlineData();
+		_m.reservEnd = _m.data + N;
+	#if OEL_MEM_BOUND_DEBUG_LVL
+		::new(_detail::DebugHeaderOf(_m.data)) _detail::DebugAllocationHeader{};
+	#endif
+	}
+
+	template< typename, typename, typename > friend class _detail::DynarrLease;
+
+	_internBase load() const noexcept  { return _m.load(); }
+	// Goes back to inline storage if the lease ended without any, because allocation threw after freeing
+	void store(const _internBase & b) noexcept
+	{
+		if( b.data )
+			_m.store(b);
+		else
+			_initInline();
+	}
+
+	auto _lease() noexcept
+	{
+		allocator_type & a = _m;
+		return _detail::DynarrLease<T, _leaseAlloc, small_dynarray>(*this, _leaseAlloc{a, _buf});
+	}
+
+	void _freeHeap() noexcept
+	{
+		if( !is_inline() )
+			_allocateWrap::dealloc(_m, _m.data, capacity());
+	}
+
+	// Requires that this is empty and using inline storage
+	void _moveFrom(small_dynarray & other) noexcept
+	{
+		if( other.is_inline() )
+		{
+			_m.end = _detail::Relocate(other._m.data, other.size(), _m.data);
+			other._m.end = other._m.data;
+		}
+		else
+		{	_m.store(other._m.load());
+			other._initInline();
+		}
+	}
+};
+
+template< typename T, size_t N, typename Alloc >
+small_dynarray<T, N, Alloc> &
+	small_dynarray<T, N, Alloc>::operator =(small_dynarray && other) &
+	noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value )
+{
+	[[maybe_unused]] allocator_type & myA = _m;
+	if constexpr( !(_alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value) )
+	    if( myA != other._m )
+		{
+			assign_range(other | view::move);
+			return *this;
+		}
+
+	_detail::Destroy(_m.data, _m.end);
+	_freeHeap();
+	_initInline();
+	if constexpr( _alloTrait::propagate_on_container_move_assignment::value )
+		myA = static_cast<allocator_type &&>(other._m);
+
+	_moveFrom(other);
+	return *this;
+}
+
+template< typename T, size_t N, typename Alloc >
+void small_dynarray<T, N, Alloc>::shrink_to_fit()
+{
+	if( is_inline() )
+		return;
+
+	auto const n = size();
+	if( n <= N )
+	{	// Relocate back to inline storage
+		T *const heapData = _m.data;
+		auto const cap = capacity();
+
+		_initInline();
+		_m.end = _detail::Relocate(heapData, n, _m.data);
+		_allocateWrap::dealloc(_m, heapData, cap);
+	}
+	else
+	{	_lease()->shrink_to_fit();
+	}
+}
+
+} // namespace oel
@@ -0,0 +1,479 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "dynarray.h"
+#include "view/subrange.h"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+
+/** @file
+*/
+
+namespace oel
+{
+namespace _detail
+{
+	template< typename... Ts >
+	struct SoaRowIter
+	{
+		using iterator_category = std::random_access_iterator_tag;
+
+		using difference_type = ptrdiff_t;
+		using value_type      = std::tuple< std::remove_const_t<Ts>... >;
+		using pointer         = void;
+		using reference       = std::tuple<Ts &...>;
+
+		using const_type = SoaRowIter<const Ts...>;
+
+		operator const_type() const noexcept  { return {_cols, _index}; }
+
+		reference operator*() const noexcept
+			{
+				return std::apply([i = _index](auto *... cols) { return reference{cols[i]...}; }, _cols);
+			}
+
+		reference operator[](difference_type offset) const noexcept  { return *(*this + offset); }
+
+		SoaRowIter & operator++() & noexcept  { ++_index;  return *this; }
+		SoaRowIter & operator--() & noexcept  { --_index;  return *this; }
+
+		SoaRowIter operator++(int) & noexcept  { auto tmp = *this;  ++_index;  return tmp; }
+		SoaRowIter operator--(int) & noexcept  { auto tmp = *this;  --_index;  return tmp; }
+
+		SoaRowIter & operator+=(difference_type offset) & noexcept  { _index += offset;  return *this; }
+		SoaRowIter & operator-=(difference_type offset) & noexcept  { _index -= offset;  return *this; }
+
+		friend SoaRowIter operator +(SoaRowIter it, difference_type offset) noexcept  { return it += offset; }
+		friend SoaRowIter operator +(difference_type offset, SoaRowIter it) noexcept  { return it += offset; }
+		friend SoaRowIter operator -(SoaRowIter it, difference_type offset) noexcept  { return it -= offset; }
+
+		friend difference_type operator -(const SoaRowIter & left, const SoaRowIter & right) noexcept
+			{
+				return static_cast<difference_type>(left._index - right._index);
+			}
+
+		friend bool operator==(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index == right._index; }
+		friend bool operator!=(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index != right._index; }
+		friend bool operator <(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index < right._index; }
+		friend bool operator >(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index > right._index; }
+		friend bool operator<=(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index <= right._index; }
+		friend bool operator>=(const SoaRowIter & left, const SoaRowIter & right) noexcept  { return left._index >= right._index; }
+
+		std::tuple<Ts *...> _cols;
+		size_t _index;
+	};
+}
+
+
+//! Resizable structure of arrays, with each of Ts in its own contiguous column inside a single allocation
+/**
+* All columns grow together, with one allocation and one relocation pass per column. Each of Ts must be
+* trivially relocatable or noexcept move constructible, same as for dynarray. The allocator is rebound to
+* a type with the greatest alignment of Ts, and can select growth policy like for dynarray.
+*
+* A row is accessed as `std::tuple<Ts &...>`, and the row iterator is random access with that as reference
+* (so it is only an input iterator in terms of the C++17 standard library). Use column to get a range that can
+* be passed to algorithms. Elements are constructed with placement new, Alloc::construct is not used. */
+template< typename Alloc, typename... Ts >
+class basic_soa_dynarray
+{
+	static_assert(sizeof...(Ts) > 0);
+
+	static constexpr size_t _nCols = sizeof...(Ts);
+	static constexpr size_t _rowBytes = (sizeof(Ts) + ...);
+	static constexpr size_t _maxAlign = std::max({alignof(Ts)...});
+
+	struct alignas(_maxAlign) _unit
+	{
+		unsigned char bytes[_maxAlign];
+	};
+
+	using _alloTrait = typename std::allocator_traits<Alloc>::template rebind_traits<_unit>;
+	using _growth    = decltype( _detail::GrowthPolicy<typename _alloTrait::allocator_type>(0) );
+
+	template< size_t I >
+	using _col_t = std::tuple_element_t< I, std::tuple<Ts...> >;
+
+public:
+	using value_type      = std::tuple<Ts...>;
+	using allocator_type  = typename _alloTrait::allocator_type;
+	using difference_type = ptrdiff_t;
+	using size_type       = size_t;
+
+	using reference       = std::tuple<Ts &...>;
+	using const_reference = std::tuple<const Ts &...>;
+
+	using iterator       = _detail::SoaRowIter<Ts...>;
+	using const_iterator = _detail::SoaRowIter<const Ts...>;
+
+	basic_soa_dynarray() noexcept(noexcept( Alloc{} ))  : basic_soa_dynarray(Alloc{}) {}
+	explicit basic_soa_dynarray(Alloc a) noexcept       : _m(a) {}
+
+	//! Construct empty with space reserved for at least capacity rows
+	basic_soa_dynarray(reserve_tag, size_type capacity, Alloc a = Alloc{})   : _m(a) { reserve(capacity); }
+
+	template< typename InputRange >
+	basic_soa_dynarray(from_range_t, InputRange && r, Alloc a = Alloc{})   : _m(a) { append_range(r); }
+
+	basic_soa_dynarray(basic_soa_dynarray && other) noexcept
+	 :	_m(std::move(other._m))
+	{
+		other._m.cols = {};
+		other._m.size = other._m.capacity = 0;
+	}
+	explicit basic_soa_dynarray(const basic_soa_dynarray & other)
+	 :	_m( _alloTrait::select_on_container_copy_construction(other._m) ) { append_range(other); }
+
+	~basic_soa_dynarray()   { _free(); }
+
+	//! Requires that allocators are always equal or propagate_on_container_move_assignment is true
+	basic_soa_dynarray & operator =(basic_soa_dynarray && other) & noexcept;
+	basic_soa_dynarray & operator =(const basic_soa_dynarray & other) &
+		{
+			if( this != &other )
+			{
+				clear();
+				append_range(other);
+			}
+			return *this;
+		}
+
+	//! Appends rows from a range of tuple-like elements (std::get<I> must work), such as std::tuple or std::pair
+	/**
+	* If the range is forward and all Ts are nothrow constructible from the element fields,
+	* each column is filled in a separate pass. Otherwise, it is done row by row, and if an exception
+	* is thrown, the rows appended before it are kept. */
+	template< typename InputRange >
+	void append_range(InputRange && source);
+
+	//! Constructs each column of the new row from the corresponding argument
+	/** Beware, passing an element of same soa_dynarray is unsafe if it has to grow, the old block is freed
+	* before the new row is constructed */
+	template< typename... Args >
+	reference emplace_back(Args &&... args) &;
+	//! Beware, passing an element of same soa_dynarray is often unsafe, as for emplace_back
+	void push_back(const Ts &... vals)  { emplace_back(vals...); }
+
+	void pop_back() noexcept
+		{
+			OEL_ASSERT(_m.size > 0);
+			--_m.size;
+			_forEachCol([n = _m.size](auto * col) { _detail::Destroy(col + n, col + n + 1); });
+		}
+
+	//! Value-initializes added rows
+	void resize(size_type n);
+
+	void clear() noexcept   { _destroyFrom(0); }
+
+	void reserve(size_type minCap)
+		{
+			if( _m.capacity < minCap )
+				_realloc(_calcCapChecked(minCap));
+		}
+
+	void shrink_to_fit()
+		{
+			if( _m.size < _m.capacity )
+				_realloc(_m.size);
+		}
+
+	[[nodiscard]] bool empty() const noexcept  { return _m.size == 0; }
+
+	size_type size() const noexcept       { return _m.size; }
+
+	size_type capacity() const noexcept   { return _m.capacity; }
+
+	size_type max_size() const noexcept
+		{
+			return (_alloTrait::max_size(_m) - _nCols) * sizeof(_unit) / _rowBytes;
+		}
+
+	allocator_type get_allocator() const noexcept   { return _m; }
+
+	//! Pointer to the first element of column I
+	template< size_t I >
+	_col_t<I> *       data() noexcept         { return std::get<I>(_m.cols); }
+	template< size_t I >
+	const _col_t<I> * data() const noexcept   { return std::get<I>(_m.cols); }
+
+	//! Contiguous range of column I
+	template< size_t I >
+	auto column() noexcept         { return view::subrange(data<I>(), data<I>() + _m.size); }
+	template< size_t I >
+	auto column() const noexcept   { return view::subrange(data<I>(), data<I>() + _m.size); }
+
+	iterator       begin() noexcept          { return {_m.cols, 0}; }
+	const_iterator begin() const noexcept    { return iterator{_m.cols, 0}; }
+	const_iterator cbegin() const noexcept   { return begin(); }
+
+	iterator       end() noexcept          { return {_m.cols, _m.size}; }
+	const_iterator end() const noexcept    { return iterator{_m.cols, _m.size}; }
+	const_iterator cend() const noexcept   { return end(); }
+
+	reference       operator[](size_type index) noexcept        { OEL_ASSERT(index < _m.size);  return begin()[index]; }
+	const_reference operator[](size_type index) const noexcept  { OEL_ASSERT(index < _m.size);  return begin()[index]; }
+
+	reference       back() noexcept         { return (*this)[_m.size - 1]; }
+	const_reference back() const noexcept   { return (*this)[_m.size - 1]; }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	using _usedAlloc_7KQw = allocator_type; // guarding against name collision due to inheritance (MSVC)
+
+	struct _members : public _usedAlloc_7KQw
+	{
+		std::tuple<Ts *...> cols{};
+		size_type size{};
+		size_type capacity{};
+
+		_members(_usedAlloc_7KQw a) noexcept
+		 :	_usedAlloc_7KQw(std::move(a))
+		{}
+	}
+	_m;
+
+
+	// Byte offset of each column, followed by the total number of bytes
+	static std::array<size_t, _nCols + 1> _layout(size_type const cap) noexcept
+	{
+		constexpr size_t sizes[]  {sizeof(Ts)...};
+		constexpr size_t aligns[] {alignof(Ts)...};
+
+		std::array<size_t, _nCols + 1> offsets{};
+		size_t n{};
+		for( size_t i{}; i < _nCols; ++i )
+		{
+			n = (n + (aligns[i] - 1)) & ~(aligns[i] - 1);
+			offsets[i] = n;
+			n += sizes[i] * cap;
+		}
+		offsets[_nCols] = n;
+		return offsets;
+	}
+
+	static size_type _unitCount(size_type const cap) noexcept
+	{
+		return (_layout(cap)[_nCols] + (sizeof(_unit) - 1)) / sizeof(_unit);
+	}
+
+	template< typename Func >
+	void _forEachCol(Func f)
+	{
+		std::apply([&f](auto *... cols) { (f(cols), ...); }, _m.cols);
+	}
+
+	size_type _calcCapChecked(size_type const minCap) const
+	{
+		if( minCap <= max_size() )
+		{
+			auto const c = _growth::grow(_m.capacity, minCap, _rowBytes);
+			return c < max_size() ? c : max_size();
+		}
+		else
+		{	_detail::LengthError::raise();
+		}
+	}
+
+	void _realloc(size_type const newCap)
+	{
+		std::tuple<Ts *...> newCols{};
+		if( newCap > 0 )
+		{
+			auto const block = reinterpret_cast<unsigned char *>( _alloTrait::allocate(_m, _unitCount(newCap)) );
+			auto const offsets = _layout(newCap);
+			_setCols(newCols, block, offsets, std::index_sequence_for<Ts...>{});
+
+			_relocateCols(newCols, std::index_sequence_for<Ts...>{});
+		}
+		_deallocate();
+		_m.cols = newCols;
+		_m.capacity = newCap;
+	}
+
+	template< size_t... Is >
+	static void _setCols(std::tuple<Ts *...> & cols, unsigned char * block,
+	                     const std::array<size_t, _nCols + 1> & offsets, std::index_sequence<Is...>) noexcept
+	{
+		((std::get<Is>(cols) = reinterpret_cast<_col_t<Is> *>(block + offsets[Is])), ...);
+	}
+
+	template< size_t... Is >
+	void _relocateCols(std::tuple<Ts *...> & dest, std::index_sequence<Is...>) noexcept
+	{
+		(_detail::Relocate(std::get<Is>(_m.cols), _m.size, std::get<Is>(dest)), ...);
+	}
+
+	void _deallocate() noexcept
+	{
+		if( auto const block = std::get<0>(_m.cols) )
+			_alloTrait::deallocate(_m, reinterpret_cast<_unit *>(block), _unitCount(_m.capacity));
+	}
+
+	void _destroyFrom(size_type const newSize) noexcept
+	{
+		_forEachCol([&](auto * col) { _detail::Destroy(col + newSize, col + _m.size); });
+		_m.size = newSize;
+	}
+
+	void _free() noexcept
+	{
+		_destroyFrom(0);
+		_deallocate();
+	}
+
+	template< typename Src, size_t... Is >
+	void _appendColumns(Src src, size_type const n, std::index_sequence<Is...>) noexcept
+	{
+		(_fillColumn<Is>(src, n), ...);
+		_m.size += n;
+	}
+
+	template< size_t I, typename Src >
+	void _fillColumn(Src src, size_type const n) noexcept
+	{
+		auto dest = std::get<I>(_m.cols) + _m.size;
+		for( size_type k{}; k < n; ++k, ++src, ++dest )
+			::new(static_cast<void *>(dest)) _col_t<I>(std::get<I>(*src));
+	}
+
+	template< typename Elem, size_t... Is >
+	static constexpr bool _allNothrowFrom(std::index_sequence<Is...>)
+	{
+		return ( std::is_nothrow_constructible_v< _col_t<Is>, decltype(std::get<Is>(std::declval<Elem>())) > and ... );
+	}
+
+	template< typename Tuple, size_t... Is >
+	void _emplaceTuple(Tuple && t, std::index_sequence<Is...>)
+	{
+		emplace_back(std::get<Is>(static_cast<Tuple &&>(t))...);
+	}
+};
+
+//! Structure of arrays with the default allocator, see basic_soa_dynarray
+template< typename... Ts >
+using soa_dynarray = basic_soa_dynarray<allocator<>, Ts...>;
+
+
+template< typename Alloc, typename... Ts >
+basic_soa_dynarray<Alloc, Ts...> &
+	basic_soa_dynarray<Alloc, Ts...>::operator =(basic_soa_dynarray && other) & noexcept
+{
+	static_assert( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value );
+
+	if( this != &other )
+	{
+		_free();
+		if constexpr( _alloTrait::propagate_on_container_move_assignment::value )
+		{
+			allocator_type & a = _m;
+			a = static_cast<allocator_type &&>(other._m);
+		}
+		_m.cols     = other._m.cols;
+		_m.size     = other._m.size;
+		_m.capacity = other._m.capacity;
+		other._m.cols = {};
+		other._m.size = other._m.capacity = 0;
+	}
+	return *this;
+}
+
+template< typename Alloc, typename... Ts >
+template< typename... Args >
+typename basic_soa_dynarray<Alloc, Ts...>::reference
+	basic_soa_dynarray<Alloc, Ts...>::emplace_back(Args &&... args) &
+{
+	static_assert(sizeof...(Args) == _nCols, "One argument per column");
+
+	if( _m.size == _m.capacity )
+		_realloc(_growth::grow_one(_m.capacity, _rowBytes));
+
+	auto const i = _m.size;
+	size_t nDone{};
+	OEL_TRY_
+	{
+		std::apply(
+			[&](auto *... cols)
+			{
+				(( ::new(static_cast<void *>(cols + i)) std::remove_pointer_t<decltype(cols)>(static_cast<Args &&>(args)),
+				   ++nDone ), ...);
+			},
+			_m.cols );
+	}
+	OEL_CATCH_ALL
+	{	// Destroy the columns of the new row that were constructed
+		size_t c{};
+		_forEachCol([&](auto * col) { if( c++ < nDone ) _detail::Destroy(col + i, col + i + 1); });
+		OEL_RETHROW;
+	}
+	++_m.size;
+	return (*this)[i];
+}
+
+template< typename Alloc, typename... Ts >
+template< typename InputRange >
+void basic_soa_dynarray<Alloc, Ts...>::append_range(InputRange && source)
+{
+	using Elem = decltype( *oel::begin_(source) );
+	constexpr auto seq = std::index_sequence_for<Ts...>{};
+
+	if constexpr( iter_is< iterator_t<InputRange>, std::forward_iterator_tag > and _allNothrowFrom<Elem>(seq) )
+	{
+		auto const n = _detail::UDist(source);
+		reserve(_m.size + n);
+		_appendColumns(oel::begin_(source), n, seq);
+	}
+	else
+	{	auto it = oel::begin_(source);
+		auto l  = oel::end_(source);
+		for( ; it != l; ++it )
+			_emplaceTuple(*it, seq);
+	}
+}
+
+template< typename Alloc, typename... Ts >
+void basic_soa_dynarray<Alloc, Ts...>::resize(size_type const n)
+{
+	if( n <= _m.size )
+	{
+		_destroyFrom(n);
+	}
+	else
+	{	reserve(n);
+
+		auto const oldSize = _m.size;
+		size_t nDone{};
+		OEL_TRY_
+		{
+			_forEachCol(
+				[&](auto * col)
+				{
+					using C = std::remove_pointer_t<decltype(col)>;
+					_detail::ValueInit::call(col + oldSize, col + n, std::allocator<C>{});
+					++nDone;
+				} );
+		}
+		OEL_CATCH_ALL
+		{
+			size_t c{};
+			_forEachCol([&](auto * col) { if( c++ < nDone ) _detail::Destroy(col + oldSize, col + n); });
+			OEL_RETHROW;
+		}
+		_m.size = n;
+	}
+}
+
+} // namespace oel
@@ -0,0 +1,327 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "allocator.h"
+#include "growth_policy.h"
+#include "auxi/dynarray_detail.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#if defined __cpp_rtti or defined _CPPRTTI
+#include <typeinfo>
+#endif
+
+/** @file
+*/
+
+namespace oel
+{
+
+//! Snapshot of the counters that stats_allocator keeps for one element type
+struct allocation_stats
+{
+	//! From std::type_info::name, or empty if compiled without RTTI
+	const char *  type_name;
+	size_t        element_size;
+
+	std::uint64_t allocations;
+	std::uint64_t deallocations;
+	std::uint64_t reallocations;
+	//! Reallocations that returned the same pointer
+	std::uint64_t in_place_reallocations;
+	//! Bytes of elements moved to a new block by dynarray growth, insert and shrink_to_fit, or by realloc
+	std::uint64_t bytes_relocated;
+	//! Sum of unused capacity in bytes right after each time dynarray changed capacity
+	std::uint64_t slack_bytes;
+	//! Number of times dynarray changed capacity, whether relocating or not
+	std::uint64_t capacity_changes;
+
+	std::uint64_t bytes_in_use;
+	std::uint64_t peak_bytes;
+};
+
+//! Wraps another allocator, counting allocations, relocations and bytes per element type
+/**
+* Counting is done with relaxed atomic operations on counters that are shared by all stats_allocator
+* with the same T, so the overhead is low enough to leave on in production. dynarray reports how many
+* elements it relocates through the member function on_relocate. All else is passed on to Alloc,
+* including reallocate and growth_policy. */
+template< typename T, typename Alloc = allocator<T> >
+class stats_allocator : private Alloc
+{
+	using _traits = std::allocator_traits<Alloc>;
+
+public:
+	using value_type = T;
+
+	using propagate_on_container_copy_assignment = typename _traits::propagate_on_container_copy_assignment;
+	using propagate_on_container_move_assignment = typename _traits::propagate_on_container_move_assignment;
+	using propagate_on_container_swap            = typename _traits::propagate_on_container_swap;
+	using is_always_equal                        = typename _traits::is_always_equal;
+
+	using growth_policy = decltype( _detail::GrowthPolicy<Alloc>(0) );
+
+	template< typename U >
+	struct rebind
+	{
+		using other = stats_allocator< U, typename _traits::template rebind_alloc<U> >;
+	};
+
+	static constexpr bool can_reallocate() noexcept  { return allocator_can_realloc<Alloc>(); }
+
+	size_t max_size() const noexcept  { return _traits::max_size(*this); }
+
+	T *  allocate(size_t count);
+
+	allocation_result<T *> allocate_at_least(size_t count);
+
+	//! Only if Alloc has allocate_zeroed
+	template< typename A = Alloc >
+	auto allocate_zeroed(size_t count)
+	->	decltype( std::declval<A &>().allocate_zeroed(count) )
+		{
+			A & a = *this;
+			auto const p = a.allocate_zeroed(count);
+			_countAllocation(count);
+			return p;
+		}
+
+	//! Only usable if can_reallocate() is true
+	allocation_result<T *> reallocate_at_least(T * ptr, size_t oldCount, size_t newCount);
+
+	void deallocate(T * ptr, size_t count) noexcept;
+
+	//! Called by dynarray once per change of capacity
+	/** @param nRelocated elements moved, including those shifted by an insert that grew in place
+	* @param size the size that the operation which changed capacity ends with */
+	void on_relocate(size_t nRelocated, size_t size, size_t capacity) noexcept;
+
+	stats_allocator() = default;
+
+	stats_allocator(const Alloc & a) noexcept : Alloc(a) {}
+
+	template< typename U, typename A2 >
+	stats_allocator(const stats_allocator<U, A2> & other) noexcept
+	 :	Alloc(other.inner_allocator()) {}
+
+	const Alloc & inner_allocator() const noexcept  { return *this; }
+
+	template< typename U, typename A2 >
+	friend bool operator==(const stats_allocator & a, const stats_allocator<U, A2> & b) noexcept
+		{
+			return a.inner_allocator() == b.inner_allocator();
+		}
+	template< typename U, typename A2 >
+	friend bool operator!=(const stats_allocator & a, const stats_allocator<U, A2> & b) noexcept
+		{
+			return !(a == b);
+		}
+
+private:
+	static void _countAllocation(size_t count) noexcept;
+};
+
+//! Current values of the counters for element type T
+template< typename T >
+allocation_stats allocation_stats_of() noexcept;
+
+//! Calls f with an allocation_stats for each element type that stats_allocator has been used with
+template< typename Func >
+void for_each_allocation_stats(Func f);
+
+//! Prints one line per element type that stats_allocator has been used with
+inline void print_allocation_stats(std::FILE * out = stderr);
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+namespace _detail
+{
+	struct StatsCounters
+	{
+		using U64 = std::atomic<std::uint64_t>;
+
+		const char *const    typeName;
+		size_t const         elemSize;
+		StatsCounters *const next;
+
+		U64 allocations{};
+		U64 deallocations{};
+		U64 reallocations{};
+		U64 inPlaceReallocations{};
+		U64 bytesRelocated{};
+		U64 slackBytes{};
+		U64 capacityChanges{};
+		U64 bytesInUse{};
+		U64 peakBytes{};
+
+		static std::atomic<StatsCounters *> & head() noexcept
+		{
+			static std::atomic<StatsCounters *> h;
+			return h;
+		}
+
+		StatsCounters(const char * name, size_t size) noexcept
+		 :	typeName{name}, elemSize{size}, next{_pushSelf()} {}
+
+		static void add(U64 & c, std::uint64_t n) noexcept  { c.fetch_add(n, std::memory_order_relaxed); }
+
+		void addInUse(std::uint64_t const nBytes) noexcept
+		{
+			auto const now = bytesInUse.fetch_add(nBytes, std::memory_order_relaxed) + nBytes;
+			auto peak = peakBytes.load(std::memory_order_relaxed);
+			while( peak < now and !peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed) )
+			{}
+		}
+
+		void subInUse(std::uint64_t const nBytes) noexcept
+		{
+			bytesInUse.fetch_sub(nBytes, std::memory_order_relaxed);
+		}
+
+		allocation_stats snapshot() const noexcept
+		{
+			constexpr auto o = std::memory_order_relaxed;
+			return
+			{	typeName, elemSize,
+				allocations.load(o), deallocations.load(o), reallocations.load(o), inPlaceReallocations.load(o),
+				bytesRelocated.load(o), slackBytes.load(o), capacityChanges.load(o),
+				bytesInUse.load(o), peakBytes.load(o)
+			};
+		}
+
+	private:
+		// The next member is initialized before this is published, so readers see a complete list
+		StatsCounters * _pushSelf() noexcept
+		{
+			auto & h = head();
+			auto old = h.load(std::memory_order_relaxed);
+			while( !h.compare_exchange_weak(old, this, std::memory_order_release, std::memory_order_relaxed) )
+			{}
+			return old;
+		}
+	};
+
+	template< typename T >
+	StatsCounters & StatsOf() noexcept
+	{
+	#if defined __cpp_rtti or defined _CPPRTTI
+		static StatsCounters c{typeid(T).name(), sizeof(T)};
+	#else
+		static StatsCounters c{"", sizeof(T)};
+	#endif
+		return c;
+	}
+}
+
+template< typename T, typename Alloc >
+T * stats_allocator<T, Alloc>::allocate(size_t const count)
+{
+	Alloc & a = *this;
+	// Not allocate_at_least, as the caller will deallocate with count
+	auto const p = _traits::allocate(a, count);
+	_countAllocation(count);
+	return p;
+}
+
+template< typename T, typename Alloc >
+allocation_result<T *> stats_allocator<T, Alloc>::allocate_at_least(size_t const count)
+{
+	Alloc & a = *this;
+	auto const r = _detail::AllocateAtLeast(a, count);
+	_countAllocation(r.count);
+	return r;
+}
+
+template< typename T, typename Alloc >
+void stats_allocator<T, Alloc>::_countAllocation(size_t const count) noexcept
+{
+	auto & c = _detail::StatsOf<T>();
+	c.add(c.allocations, 1);
+	c.addInUse(sizeof(T) * count);
+}
+
+template< typename T, typename Alloc >
+allocation_result<T *> stats_allocator<T, Alloc>::reallocate_at_least(T *const ptr, size_t const oldCount, size_t const newCount)
+{
+	Alloc & a = *this;
+	auto const r = _detail::ReallocAtLeast(a, ptr, oldCount, newCount);
+
+	auto & c = _detail::StatsOf<T>();
+	if( ptr )
+	{
+		c.add(c.reallocations, 1);
+		if( r.ptr == ptr )
+			c.add(c.inPlaceReallocations, 1);
+
+		c.subInUse(sizeof(T) * oldCount);
+	}
+	else
+	{	c.add(c.allocations, 1);
+	}
+	c.addInUse(sizeof(T) * r.count);
+	return r;
+}
+
+template< typename T, typename Alloc >
+void stats_allocator<T, Alloc>::deallocate(T *const ptr, size_t const count) noexcept
+{
+	if( ptr )
+	{
+		auto & c = _detail::StatsOf<T>();
+		c.add(c.deallocations, 1);
+		c.subInUse(sizeof(T) * count);
+	}
+	_traits::deallocate(*this, ptr, count);
+}
+
+template< typename T, typename Alloc >
+void stats_allocator<T, Alloc>::on_relocate(size_t const nRelocated, size_t const size, size_t const capacity) noexcept
+{
+	auto & c = _detail::StatsOf<T>();
+	c.add(c.bytesRelocated, sizeof(T) * nRelocated);
+	c.add(c.slackBytes, sizeof(T) * (capacity - size));
+	c.add(c.capacityChanges, 1);
+}
+
+template< typename T >
+inline allocation_stats allocation_stats_of() noexcept
+{
+	return _detail::StatsOf<T>().snapshot();
+}
+
+template< typename Func >
+void for_each_allocation_stats(Func f)
+{
+	auto p = _detail::StatsCounters::head().load(std::memory_order_acquire);
+	for( ; p; p = p->next )
+		f(p->snapshot());
+}
+
+inline void print_allocation_stats(std::FILE *const out)
+{
+	for_each_allocation_stats([out](const allocation_stats & s)
+	{
+		std::fprintf(out,
+			"%s (size %zu): allocations %llu, deallocations %llu, reallocations %llu (in place %llu), "
+			"bytes relocated %llu, slack bytes %llu over %llu capacity changes, bytes in use %llu, peak %llu\n",
+			s.type_name, s.element_size,
+			static_cast<unsigned long long>(s.allocations), static_cast<unsigned long long>(s.deallocations),
+			static_cast<unsigned long long>(s.reallocations), static_cast<unsigned long long>(s.in_place_reallocations),
+			static_cast<unsigned long long>(s.bytes_relocated), static_cast<unsigned long long>(s.slack_bytes),
+			static_cast<unsigned long long>(s.capacity_changes),
+			static_cast<unsigned long long>(s.bytes_in_use), static_cast<unsigned long long>(s.peak_bytes));
+	});
+}
+
+} // namespace oel
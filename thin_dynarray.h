@@ -0,0 +1,454 @@
+#pragma once
+
+// Copyright 2025 Ole Erik Peistorpet
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#include "auxi/dynarray_lease.h"
+
+/** @file
+*/
+
+namespace oel
+{
+namespace _detail
+{
+	struct ThinDynarrHeader
+	{
+		size_t size;
+		size_t capacity;
+	};
+
+	// Used by thin_dynarray. Adds space for ThinDynarrHeader in front of each block
+	template< typename T, typename Alloc >
+	struct ThinAlloc
+	{
+		using value_type = T;
+
+		// Count of T that covers the header, which is at the start of the block from Alloc, so it's aligned
+		static constexpr size_t headerCount = (sizeof(ThinDynarrHeader) + sizeof(T) - 1) / sizeof(T);
+
+		Alloc innerAlloc;
+
+		static constexpr bool can_reallocate() noexcept  { return allocator_can_realloc<Alloc>(); }
+
+		size_t max_size() const noexcept
+		{
+			return std::allocator_traits<Alloc>::max_size(innerAlloc) - headerCount;
+		}
+
+		T * allocate(size_t n)
+		{
+			return std::allocator_traits<Alloc>::allocate(innerAlloc, n + headerCount) + headerCount;
+		}
+
+		allocation_result<T *> allocate_at_least(size_t n)
+		{
+			return _skipHeader(_detail::AllocateAtLeast(innerAlloc, n + headerCount));
+		}
+
+		template< typename A = Alloc >
+		auto allocate_zeroed(size_t n)
+		->	decltype( std::declval<A &>().allocate_zeroed(n) )
+		{	return    innerAlloc.allocate_zeroed(n + headerCount) + headerCount; }
+
+		allocation_result<T *> reallocate_at_least(T * p, size_t oldN, size_t n)
+		{
+			if( p )
+			{
+				p -= headerCount;
+				oldN += headerCount;
+			}
+			return _skipHeader(_detail::ReallocAtLeast(innerAlloc, p, oldN, n + headerCount));
+		}
+
+		void deallocate(T * p, size_t n) noexcept
+		{
+			std::allocator_traits<Alloc>::deallocate(innerAlloc, p - headerCount, n + headerCount);
+		}
+
+		template< typename U, typename... Args >
+		void construct(U * p, Args &&... args)
+		{
+			std::allocator_traits<Alloc>::construct(innerAlloc, p, static_cast<Args &&>(args)...);
+		}
+
+		friend bool operator==(const ThinAlloc & x, const ThinAlloc & y)  { return x.innerAlloc == y.innerAlloc; }
+		friend bool operator!=(const ThinAlloc & x, const ThinAlloc & y)  { return x.innerAlloc != y.innerAlloc; }
+
+		static allocation_result<T *> _skipHeader(allocation_result<T *> r) noexcept
+		{
+			return {r.ptr + headerCount, r.count - headerCount};
+		}
+	};
+}
+
+
+//! Resizable array that is a single pointer, with size and capacity stored in a header of the allocated block
+/**
+* Has the same interface as dynarray, and shares its implementation of growth, relocation, insert and append.
+* Only differences are documented. Intended for arrays of arrays, where most inner arrays are small or empty.
+* An empty thin_dynarray that has never allocated is just a null pointer (unless Alloc is stateful).
+*
+* size() and capacity() need to read the header, so loops should not call them every iteration.
+* Iterators are plain pointers, even when OEL_MEM_BOUND_DEBUG_LVL is non-zero. */
+template< typename T, typename Alloc = allocator<> >
+class thin_dynarray
+{
+	using _alloTrait = typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+public:
+	using value_type      = T;
+	using allocator_type  = typename _alloTrait::allocator_type;
+	using difference_type = ptrdiff_t;
+	using size_type       = size_t;
+
+	using iterator       = T *;
+	using const_iterator = const T *;
+
+	thin_dynarray() noexcept(noexcept( Alloc{} ))  : thin_dynarray(Alloc{}) {}
+	explicit thin_dynarray(Alloc a) noexcept       : _m(a) {}
+
+	//! Construct empty thin_dynarray with space reserved for at least capacity elements
+	thin_dynarray(reserve_tag, size_type capacity, Alloc a = Alloc{})   : _m(a) { reserve(capacity); }
+
+	//! @copydoc dynarray::dynarray(size_type, for_overwrite_t, Alloc)
+	thin_dynarray(size_type size, for_overwrite_t, Alloc a = Alloc{})   : _m(a) { resize_for_overwrite(size); }
+	//! (Value-initializes elements, same as std::vector)
+	explicit thin_dynarray(size_type size, Alloc a = Alloc{})           : _m(a) { resize(size); }
+
+	template< typename InputRange >
+	thin_dynarray(from_range_t, InputRange && r, Alloc a = Alloc{})   : _m(a) { append_range(r); }
+
+	thin_dynarray(std::initializer_list<T> il, Alloc a = Alloc{})     : _m(a) { append_range(il); }
+
+	thin_dynarray(thin_dynarray && other) noexcept
+	 :	_m(static_cast<allocator_type &>(other._m))
+	{
+		_m.store(other._m.load());
+		other._m.store({});
+	}
+	explicit thin_dynarray(const thin_dynarray & other)
+	 :	_m( _alloTrait::select_on_container_copy_construction(other._m) ) { append_range(other); }
+
+	~thin_dynarray()
+	{
+		_detail::Destroy(data(), end());
+		_free();
+	}
+
+	thin_dynarray & operator =(thin_dynarray && other) &
+		noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value );
+	thin_dynarray & operator =(const thin_dynarray & other) &
+		{
+			if( this != &other )
+				assign_range(other);
+
+			return *this;
+		}
+	thin_dynarray & operator =(const thin_dynarray &&) = delete;
+
+	thin_dynarray & operator =(std::initializer_list<T> il) &  { assign_range(il);  return *this; }
+
+	friend void swap(thin_dynarray & a, thin_dynarray & b) noexcept
+		{
+			auto const tmp = a._m.load();
+			a._m.store(b._m.load());
+			b._m.store(tmp);
+
+			[[maybe_unused]] allocator_type & a0 = a._m;
+			[[maybe_unused]] allocator_type & a1 = b._m;
+			if constexpr( _alloTrait::propagate_on_container_swap::value )
+			{
+				using std::swap;
+				swap(a0, a1);
+			}
+			else
+			{	OEL_ASSERT(a0 == a1);
+			}
+		}
+
+	template< typename InputRange >
+	void assign_range(InputRange && source)   { _lease()->assign_range(source); }
+
+	template< typename InputRange = std::initializer_list<T> >
+	void append_range(InputRange && source)   { _lease()->append_range(source); }
+
+	void resize_for_overwrite(size_type n)    { _lease()->resize_for_overwrite(n); }
+	void resize(size_type n)                  { _lease()->resize(n); }
+
+	template< typename Range >
+	iterator insert_range(const_iterator pos, Range && source) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->insert_range(l.iter(pos), source) );
+		}
+
+	iterator insert(const_iterator pos, T && val) &       { return emplace(pos, std::move(val)); }
+	iterator insert(const_iterator pos, const T & val) &  { return emplace(pos, val); }
+
+	template< typename... Args >
+	iterator emplace(const_iterator pos, Args &&... args) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->emplace(l.iter(pos), static_cast<Args &&>(args)...) );
+		}
+
+	template< typename... Args >
+	T &  emplace_back(Args &&... args) &
+		{
+			if( _m.data )
+			{
+				auto & h = _header();
+				if( h.size < h.capacity )
+				{	// Skipping the lease for the common case
+					T *const p = _m.data + h.size;
+					_alloTrait::construct(_m, p, static_cast<Args &&>(args)...);
+					++h.size;
+					_debugSizeUpdate();
+					return *p;
+				}
+			}
+			return _lease()->emplace_back(static_cast<Args &&>(args)...);
+		}
+
+	void push_back(T && val)       { emplace_back(std::move(val)); }
+	void push_back(const T & val)  { emplace_back(val); }
+
+	void pop_back() noexcept
+		{
+			OEL_ASSERT(size() > 0);
+			auto & h = _header();
+			--h.size;
+			_m.data[h.size].~T();
+			_debugSizeUpdate();
+		}
+
+	void     unordered_erase(iterator pos)
+		{
+			auto l = _lease();
+			l->unordered_erase(l.iter(pos));
+		}
+
+	iterator erase(const_iterator pos) &
+		{
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(pos)) );
+		}
+
+	iterator erase(const_iterator first, const_iterator last) &
+		{
+			if( !_m.data ) // lets the compiler see that the size is never negative
+			{
+				OEL_ASSERT(first == last);
+				return nullptr;
+			}
+			auto l = _lease();
+			return to_pointer_contiguous( l->erase(l.iter(first), l.iter(last)) );
+		}
+
+	void     erase_to_end(const_iterator first) noexcept
+		{
+			auto const newEnd = const_cast<T *>(first);
+			OEL_ASSERT(data() <= newEnd and newEnd <= end());
+
+			_detail::Destroy(newEnd, end());
+			if( _m.data )
+			{
+				_header().size = static_cast<size_t>(newEnd - _m.data);
+				_debugSizeUpdate();
+			}
+		}
+
+	void     clear() noexcept   { erase_to_end(_m.data); }
+
+	void     reserve(size_type minCap)
+		{
+			if( capacity() < minCap )
+				_lease()->reserve(minCap);
+		}
+
+	void     shrink_to_fit()   { _lease()->shrink_to_fit(); }
+
+	[[nodiscard]] bool empty() const noexcept  { return size() == 0; }
+
+	size_type size() const noexcept            { return _m.data ? _header().size : 0; }
+
+	size_type capacity() const noexcept        { return _m.data ? _header().capacity : 0; }
+
+	size_type max_size() const noexcept   { return _leaseAlloc{_m}.max_size() - _allocateWrap::sizeForHeader; }
+
+	allocator_type get_allocator() const noexcept   { return _m; }
+
+	iterator       begin() noexcept          { return _m.data; }
+	const_iterator begin() const noexcept    { return _m.data; }
+	const_iterator cbegin() const noexcept   { return _m.data; }
+
+	iterator       end() noexcept          { return _m.data + size(); }
+	const_iterator end() const noexcept    { return _m.data + size(); }
+	const_iterator cend() const noexcept   { return _m.data + size(); }
+
+	auto      rbegin() noexcept         { return std::reverse_iterator{end()}; }
+	auto      rbegin() const noexcept   { return std::reverse_iterator{end()}; }
+	auto      crbegin() const noexcept  { return std::reverse_iterator{end()}; }
+
+	auto      rend() noexcept         { return std::reverse_iterator{begin()}; }
+	auto      rend() const noexcept   { return std::reverse_iterator{begin()}; }
+	auto      crend() const noexcept  { return std::reverse_iterator{begin()}; }
+
+	T *       data() noexcept         { return _m.data; }
+	const T * data() const noexcept   { return _m.data; }
+
+	T &       front() noexcept        { return (*this)[0]; }
+	const T & front() const noexcept  { return (*this)[0]; }
+
+	T &       back() noexcept         { return (*this)[size() - 1]; }
+	const T & back() const noexcept   { return (*this)[size() - 1]; }
+
+	T &       operator[](size_type index) noexcept        { OEL_ASSERT(index < size());  return _m.data[index]; }
+	const T & operator[](size_type index) const noexcept  { OEL_ASSERT(index < size());  return _m.data[index]; }
+
+	OEL_ALWAYS_INLINE
+	T &       at(size_type index)
+		{
+			const auto & cSelf = *this;
+			return const_cast<T &>(cSelf.at(index));
+		}
+	const T & at(size_type index) const
+		{
+			if( index < size() )
+				return _m.data[index];
+			else
+				_detail::OutOfRange::raise();
+		}
+
+	friend bool operator==(const thin_dynarray & left, const thin_dynarray & right)
+		{
+			return left.size() == right.size() and
+			       std::equal(left.begin(), left.end(), right.begin());
+		}
+	friend bool operator!=(const thin_dynarray & left, const thin_dynarray & right)  { return !(left == right); }
+
+	friend bool operator <(const thin_dynarray & left, const thin_dynarray & right)
+		{
+			return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+		}
+	friend bool operator >(const thin_dynarray & left, const thin_dynarray & right)  { return right < left; }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation only in rest of the file
+
+
+private:
+	using _usedAlloc_7KQw = allocator_type; // guarding against name collision due to inheritance (MSVC)
+
+	using _leaseAlloc   = _detail::ThinAlloc<T, allocator_type>;
+	using _allocateWrap = _detail::DebugAllocateWrapper<_leaseAlloc, T *>;
+	using _header_t     = _detail::ThinDynarrHeader;
+
+	// Header is in front of DebugAllocationHeader, if any
+	static constexpr auto _headerOffset = sizeof(T) * (_allocateWrap::sizeForHeader + _leaseAlloc::headerCount);
+
+	static _header_t & _headerOf(value_type * data) noexcept
+	{
+		return *reinterpret_cast<_header_t *>(reinterpret_cast<char *>(data) - _headerOffset);
+	}
+
+	struct _storage : public _usedAlloc_7KQw
+	{
+		using B = ::oel::_detail::DynarrBase<value_type *>;
+
+		value_type * data{};
+
+		_storage(_usedAlloc_7KQw a) noexcept
+		 :	_usedAlloc_7KQw(std::move(a))
+		{}
+
+		B    load() const noexcept
+		{
+			if( data )
+			{
+				auto const & h = _headerOf(data);
+				return {data, data + h.size, data + h.capacity};
+			}
+			else
+			{	return {};
+			}
+		}
+
+		void store(const B & b) noexcept
+		{
+			data = b.data;
+			if( data )
+			{
+				::new(&_headerOf(data)) _header_t{static_cast<size_t>(b.end - b.data),
+				                                  static_cast<size_t>(b.reservEnd - b.data)};
+			}
+		}
+	}
+	_m;
+
+
+	_header_t & _header() const noexcept  { return _headerOf(_m.data); }
+
+
+	auto _lease() noexcept
+	{
+		allocator_type & a = _m;
+		return _detail::DynarrLease<T, _leaseAlloc, _storage>(_m, _leaseAlloc{a});
+	}
+
+	// Needed where the lease is skipped, since the dynarray of a lease checks iterators against the header
+	void _debugSizeUpdate() noexcept
+	{
+	#if OEL_MEM_BOUND_DEBUG_LVL
+		if( _m.data )
+			_detail::DebugHeaderOf(_m.data)->nObjects = _header().size;
+	#endif
+	}
+
+	void _free() noexcept
+	{
+		if( _m.data )
+		{
+			allocator_type & a = _m;
+			_leaseAlloc la{a};
+			_allocateWrap::dealloc(la, _m.data, capacity());
+		}
+	}
+};
+
+//! thin_dynarray is trivially relocatable if Alloc is
+template< typename T, typename Alloc >
+is_trivially_relocatable<Alloc> specify_trivial_relocate(thin_dynarray<T, Alloc>);
+
+
+template< typename T, typename Alloc >
+thin_dynarray<T, Alloc> &
+	thin_dynarray<T, Alloc>::operator =(thin_dynarray && other) &
+	noexcept( _alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value )
+{
+	[[maybe_unused]] allocator_type & myA = _m;
+	if constexpr( !(_alloTrait::propagate_on_container_move_assignment::value or _alloTrait::is_always_equal::value) )
+	    if( myA != other._m )
+		{
+			assign_range(other | view::move);
+			return *this;
+		}
+
+	_detail::Destroy(data(), end());
+	_free();
+	if constexpr( _alloTrait::propagate_on_container_move_assignment::value )
+		myA = static_cast<allocator_type &&>(other._m);
+
+	_m.store(other._m.load());
+	other._m.store({});
+	return *this;
+}
+
+} // namespace oel
@@ -0,0 +1,115 @@
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "test_classes.h"
+#include "compact_dynarray.h"
+#include "view/repeat.h"
+
+#include <string>
+
+using oel::compact_dynarray;
+
+namespace
+{
+	static_assert(sizeof(compact_dynarray<int>) == sizeof(int *) + 2 * sizeof(std::uint32_t));
+
+	static_assert(oel::is_trivially_relocatable< compact_dynarray<std::string> >::value);
+}
+
+class compactDynarrayTest : public ::testing::Test
+{
+protected:
+	compactDynarrayTest()
+	{
+		g_allocCount.clear();
+	}
+
+	~compactDynarrayTest()
+	{
+		EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+		EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+
+		g_allocCount.clear();
+		MyCounter::clearCount();
+	}
+};
+
+TEST_F(compactDynarrayTest, pushBackAndErase)
+{
+	compact_dynarray< int, TrackingAllocator<int> > a;
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+
+	for (int i = 0; i < 100; ++i)
+		a.push_back(i);
+
+	ASSERT_EQ(100U, a.size());
+	EXPECT_LE(100U, a.capacity());
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(i, a[i]);
+
+	a.erase(a.begin() + 1, a.begin() + 99);
+	ASSERT_EQ(2U, a.size());
+	EXPECT_EQ(99, a.back());
+
+	a.insert(a.begin() + 1, 5);
+	a.unordered_erase(a.begin());
+	EXPECT_EQ(99, a[0]);
+	EXPECT_EQ(5, a[1]);
+
+	a.pop_back();
+	a.shrink_to_fit();
+	EXPECT_EQ(1U, a.capacity());
+
+	a.clear();
+	EXPECT_TRUE(a.empty());
+}
+
+TEST_F(compactDynarrayTest, copyMoveAndSwap)
+{
+	compact_dynarray<std::string> a{"ab", "cd"};
+	auto b = compact_dynarray<std::string>(a);
+	EXPECT_TRUE(a == b);
+
+	auto c = std::move(a);
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+	EXPECT_TRUE(b == c);
+
+	a = {"x"};
+	swap(a, c);
+	EXPECT_EQ(2U, a.size());
+	EXPECT_EQ("x", c.at(0));
+
+	c = std::move(a);
+	EXPECT_EQ("cd", c[1]);
+	a = c;
+	EXPECT_TRUE(a == c);
+}
+
+TEST_F(compactDynarrayTest, nested)
+{
+	oel::dynarray< compact_dynarray<int> > outer;
+	for (int i = 0; i < 50; ++i)
+		outer.emplace_back(oel::from_range, oel::view::repeat(i, 3));
+
+	outer.insert(outer.begin(), compact_dynarray<int>(2));
+	ASSERT_EQ(51U, outer.size());
+	EXPECT_EQ(0, outer[0][1]);
+	EXPECT_EQ(49, outer.back()[2]);
+}
+
+TEST_F(compactDynarrayTest, maxSize)
+{
+	compact_dynarray<char> a;
+	EXPECT_GE(std::uint32_t(-1), a.max_size());
+
+#if OEL_HAS_EXCEPTIONS
+	if constexpr (sizeof(size_t) > sizeof(std::uint32_t))
+	{
+		EXPECT_THROW(a.reserve(size_t{1} << 32), std::length_error);
+	}
+#endif
+	a.resize(1000);
+	EXPECT_EQ(0, a[999]);
+}
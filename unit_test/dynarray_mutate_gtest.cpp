@@ -266,6 +266,32 @@ TEST_F(dynarrayTest, assignTrivialReloc)
 	}
 }
 
+#if OEL_HAS_EXCEPTIONS
+template< typename T >
+void testAssignDeallocatesFirst(T const val)
+{
+	dynarrayTrackingAlloc<T> d(oel::from_range, view::repeat(val, 3));
+	d.shrink_to_fit();
+	EXPECT_EQ(1, g_allocCount.nAllocations - g_allocCount.nDeallocations);
+
+	g_allocCount.countToThrowOn = 0;
+	EXPECT_THROW(d.assign_range(view::repeat(val, 5)), TestException);
+	// The old block was freed before allocating
+	EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+	EXPECT_TRUE(d.empty());
+	EXPECT_EQ(0U, d.capacity());
+
+	d.assign_range(view::repeat(val, 2));
+	EXPECT_EQ(val, d[1]);
+}
+
+TEST_F(dynarrayTest, assignDeallocatesFirst)
+{
+	testAssignDeallocatesFirst(-1);
+	testAssignDeallocatesFirst(std::string{"long string, not small string optimized"});
+}
+#endif
+
 // std::stringstream did not work using libstdc++ with -fno-exceptions
 //#if !defined __GLIBCXX__ or OEL_HAS_EXCEPTIONS
 TEST_F(dynarrayTest, assignNonForwardRange)
@@ -393,6 +419,55 @@ TEST_F(dynarrayTest, appendNonForwardRange)
 		EXPECT_EQ(i + 1, dest[i]);
 }
 
+template< typename Iter >
+struct HintedInputRange
+{
+	Iter first, last;
+	size_t hint;
+
+	Iter begin() const { return first; }
+	Iter end() const   { return last; }
+
+	size_t reserve_hint() const { return hint; }
+};
+
+TEST_F(dynarrayTest, appendNonForwardHint)
+{
+	dynarrayTrackingAlloc<int> dest{-1};
+
+	std::istringstream ss("1 2 3 4 5 6 7 8 9 10");
+	std::istream_iterator<int> it(ss), end{};
+	dest.append_range(HintedInputRange< std::istream_iterator<int> >{it, end, 10});
+
+	EXPECT_LE(11U, dest.capacity());
+	EXPECT_EQ(2, g_allocCount.nAllocations);
+	ASSERT_EQ(11U, dest.size());
+	for (int i = 0; i <= 10; ++i)
+		EXPECT_EQ(i == 0 ? -1 : i, dest[i]);
+
+	std::istringstream s2("11 12 13");
+	std::istream_iterator<int> i2(s2);
+	dest.assign_range(view::subrange(i2, end));
+	EXPECT_EQ(3U, dest.size());
+	EXPECT_EQ(13, dest.back());
+}
+
+#if OEL_HAS_EXCEPTIONS
+TEST_F(dynarrayTest, appendNonForwardThrow)
+{
+	dynarray<TrivialRelocat> dest(oel::reserve, 2);
+
+	std::istringstream ss("1 2 3 4 5");
+	std::istream_iterator<double> it(ss), end{};
+	TrivialRelocat::countToThrowOn = 3;
+	EXPECT_THROW(
+		dest.append_range(view::subrange(it, end)),
+		TestException );
+	ASSERT_EQ(3U, dest.size());
+	EXPECT_EQ(3.0, *dest[2]);
+}
+#endif
+
 TEST_F(dynarrayTest, insertRTrivial)
 {
 	// Should hit static_assert
@@ -558,6 +633,179 @@ TEST_F(dynarrayTest, insertTrivialAndCheckReturn)
 	EXPECT_TRUE( std::equal(std::begin(values), std::end(values), test.begin(), test.end()) );
 }
 
+TEST_F(dynarrayTest, insertGrowMiddle)
+{
+	static_assert(oel::allocator_can_realloc< TrackingAllocator<int> >());
+
+	dynarrayTrackingAlloc<int> d;
+	for (int i = 0; i < 200; ++i)
+	{
+		d.emplace(d.begin() + d.size() / 2, i);
+		if (i % 3 == 0)
+		{
+			int const two[]{-i, -i};
+			auto it = d.insert_range(d.begin() + 1, two);
+			EXPECT_EQ(&d[1], &*it);
+		}
+	}
+	EXPECT_EQ(200U + 2 * 67, d.size());
+	EXPECT_EQ(-198, d[1]);
+	EXPECT_EQ(-198, d[2]);
+
+	long sum{};
+	for (int v : d)
+		sum += v;
+	EXPECT_EQ(19900L - 2 * 6633, sum); // 0 + 1 + ... + 199, minus twice 0 + 3 + ... + 198
+}
+
+TEST_F(dynarrayTest, splice)
+{
+	dynarrayTrackingAlloc<TrivialRelocat> src, dest;
+	for (int i = 0; i < 6; ++i)
+		src.emplace_back(i);
+	dest.emplace_back(-1);
+	dest.emplace_back(-2);
+
+	auto const nConstruct = TrivialRelocat::nConstructions;
+	auto it = dest.splice(dest.begin() + 1, src, src.begin() + 2, src.begin() + 5);
+	EXPECT_EQ(nConstruct, TrivialRelocat::nConstructions);
+	EXPECT_EQ(&dest[1], &*it);
+
+	ASSERT_EQ(5U, dest.size());
+	ASSERT_EQ(3U, src.size());
+	double const expectDest[]{-1, 2, 3, 4, -2};
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(expectDest[i], *dest[i]);
+	EXPECT_EQ(0, *src[0]);
+	EXPECT_EQ(1, *src[1]);
+	EXPECT_EQ(5, *src[2]);
+
+	dest.splice(dest.end(), src, src.begin(), src.end());
+	EXPECT_TRUE(src.empty());
+	EXPECT_EQ(8U, dest.size());
+	EXPECT_EQ(5, *dest.back());
+
+	it = dest.splice(dest.begin(), src, src.begin(), src.end());
+	EXPECT_EQ(dest.begin(), it);
+	EXPECT_EQ(8U, dest.size());
+}
+
+TEST_F(dynarrayTest, appendDynarray)
+{
+	dynarrayTrackingAlloc<std::string> a, b;
+	b.emplace_back("one");
+	b.emplace_back("two");
+	auto const pB = b.data();
+
+	a.append(std::move(b));
+	EXPECT_EQ(pB, a.data());
+	EXPECT_TRUE(b.empty());
+	EXPECT_EQ(0U, b.capacity());
+
+	b.emplace_back("three");
+	a.append(std::move(b));
+	ASSERT_EQ(3U, a.size());
+	EXPECT_EQ("three", a[2]);
+	EXPECT_TRUE(b.empty());
+
+	dynarray<MoveOnly> c, d;
+	c.emplace_back(1.0);
+	d.emplace_back(2.0);
+	d.emplace_back(3.0);
+	c.append(std::move(d));
+	ASSERT_EQ(3U, c.size());
+	EXPECT_EQ(3.0, *c[2]);
+	EXPECT_TRUE(d.empty());
+}
+
+template< typename T >
+void testEraseIndices()
+{
+	dynarray<T> d;
+	for (int i = 0; i < 10; ++i)
+		d.emplace_back(i);
+
+	d.erase_indices(std::array<int, 0>{});
+	EXPECT_EQ(10U, d.size());
+
+	size_t const indices[]{0, 3, 4, 8};
+	d.erase_indices(indices);
+	double const expect[]{1, 2, 5, 6, 7, 9};
+	ASSERT_EQ(6U, d.size());
+	for (int i = 0; i < 6; ++i)
+		EXPECT_EQ(expect[i], *d[i]);
+
+	d.erase_indices(std::initializer_list<size_t>{5});
+	EXPECT_EQ(7, *d.back());
+
+	std::deque<unsigned> const unordered{0, 3, 4};
+	d.unordered_erase_indices(unordered);
+	ASSERT_EQ(2U, d.size());
+	EXPECT_EQ(5, *d[0]);
+	EXPECT_EQ(2, *d[1]);
+
+	d.unordered_erase_indices(std::array<int, 2>{0, 1});
+	EXPECT_TRUE(d.empty());
+
+	for (int i = 0; i < 10; ++i)
+		d.emplace_back(i);
+
+	d.unordered_erase_indices(std::array<int, 7>{1, 2, 2, 7, 8, 8, 9});
+	double const expectUnordered[]{0, 6, 5, 3, 4};
+	ASSERT_EQ(5U, d.size());
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(expectUnordered[i], *d[i]);
+
+	d.unordered_erase_indices(std::array<int, 4>{0, 0, 3, 4});
+	ASSERT_EQ(2U, d.size());
+	EXPECT_EQ(5, *d[0]);
+	EXPECT_EQ(6, *d[1]);
+}
+
+TEST_F(dynarrayTest, eraseIndices)
+{
+	testEraseIndices<TrivialRelocat>();
+	testEraseIndices<MoveOnly>();
+	EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+}
+
+TEST_F(dynarrayTest, insertRanges)
+{
+	dynarrayTrackingAlloc<int> d{0, 1, 2, 3, 4};
+	std::pair< size_t, std::vector<int> > const inserts[]
+		{	{0, {-1}}, {2, {-2, -3}}, {2, {-4}}, {5, {-5}}, {5, {}}
+		};
+	d.insert_ranges(inserts);
+	EXPECT_EQ((dynarrayTrackingAlloc<int>{-1, 0, 1, -2, -3, -4, 2, 3, 4, -5}), d);
+
+	d.insert_ranges(std::array< std::pair<int, std::array<int, 0>>, 0 >{});
+	EXPECT_EQ(10U, d.size());
+#if OEL_HAS_EXCEPTIONS
+	dynarray<TrivialRelocat> t;
+	for (int i = 0; i < 4; ++i)
+		t.emplace_back(i);
+
+	std::deque< std::tuple<int, std::vector<double>> > const tInserts
+		{	{1, {-1, -2}}, {3, {-1}}, {4, {-2}}
+		};
+	t.reserve(8);
+	for (int nOk : {3, 1, 2, 0})
+	{
+		TrivialRelocat::countToThrowOn = nOk;
+		EXPECT_THROW(t.insert_ranges(tInserts), TestException);
+		ASSERT_EQ(4U, t.size());
+		for (int i = 0; i < 4; ++i)
+			EXPECT_EQ(i, *t[i]);
+	}
+	TrivialRelocat::countToThrowOn = -1;
+	t.insert_ranges(tInserts);
+	double const expect[]{0, -1, -2, 1, 2, -1, 3, -2};
+	ASSERT_EQ(8U, t.size());
+	for (int i = 0; i < 8; ++i)
+		EXPECT_EQ(expect[i], *t[i]);
+#endif
+}
+
 TEST_F(dynarrayTest, insertRefFromSelf)
 {
 	{	dynarrayTrackingAlloc<TrivialRelocat> test;
@@ -675,6 +923,45 @@ TEST_F(dynarrayTest, resize)
 	EXPECT_TRUE(nested.back().empty());
 }
 
+TEST_F(dynarrayTest, appendAndOverwrite)
+{
+	dynarrayTrackingAlloc<char> d{'a'};
+	d.append_and_overwrite(
+		100,
+		[](char * p, size_t n)
+		{
+			EXPECT_EQ(100U, n);
+			std::memcpy(p, "bcd", 3);
+			return 3;
+		} );
+	EXPECT_EQ(4U, d.size());
+	EXPECT_LE(101U, d.capacity());
+	EXPECT_EQ('d', d.back());
+
+	auto const cap = d.capacity();
+	d.append_and_overwrite(5, [](char *, size_t) { return 0; });
+	EXPECT_EQ(4U, d.size());
+	EXPECT_EQ(cap, d.capacity());
+
+	dynarray<TrivialRelocat> nontriv{TrivialRelocat{-1}};
+	nontriv.append_and_overwrite(
+		4,
+		[](TrivialRelocat * p, size_t)
+		{
+			p[0] = TrivialRelocat{2};
+			return 1u;
+		} );
+	ASSERT_EQ(2U, nontriv.size());
+	EXPECT_EQ(2.0, *nontriv[1]);
+#if OEL_HAS_EXCEPTIONS
+	EXPECT_THROW(
+		nontriv.append_and_overwrite(3, [](TrivialRelocat *, size_t) -> size_t { throw TestException{}; }),
+		TestException );
+	EXPECT_EQ(2U, nontriv.size());
+#endif
+	EXPECT_EQ(TrivialRelocat::nConstructions - 2, TrivialRelocat::nDestruct);
+}
+
 struct NonPowerOfTwo
 {
 	char data[(sizeof(void *) * 3) / 2];
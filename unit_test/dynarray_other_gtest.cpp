@@ -2,19 +2,28 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include "test_classes.h"
+#include "arena_allocator.h"
 #include "dynarray.h"
+#include "large_block_allocator.h"
+#include "learned_capacity.h"
+#include "pool_allocator.h"
+#include "stats_allocator.h"
 #include "optimize_ext/std_variant.h"
+#include "view/counted.h"
 #include "view/move.h"
+#include "view/repeat.h"
 
 #include "gtest/gtest.h"
 #include <deque>
+#include <thread>
+#include <vector>
 #if __cpp_lib_flat_set
 #include <flat_set>
 #endif
 
 #if HAS_STD_PMR
 
-#include <memory_resource>
+#include "pmr_dynarray.h"
 
 static_assert(oel::is_trivially_relocatable< std::pmr::polymorphic_allocator<int> >::value);
 
@@ -111,6 +120,614 @@ TEST(dynarrayOtherTest, compare)
 	EXPECT_FALSE(arr[0] > arr[2]);
 }
 
+namespace
+{
+	template< typename T >
+	struct Growth3Over2Alloc : TrackingAllocator<T> // exact capacity, no allocate_at_least
+	{
+		using growth_policy = oel::growth_factor<3, 2>;
+	};
+
+	static_assert(oel::growth_factor<2, 1>::grow(5, 6, 4) == 10);
+	static_assert(oel::growth_factor<2, 1>::grow(5, 11, 4) == 11);
+	static_assert(oel::growth_factor<2, 1>::grow_one(0, 4) == 6);
+	static_assert(oel::growth_factor<2, 1>::grow_one(7, 4) == 14);
+
+	static_assert(oel::growth_size_class::round_up_bytes(1) == 16);
+	static_assert(oel::growth_size_class::round_up_bytes(128) == 128);
+	static_assert(oel::growth_size_class::round_up_bytes(129) == 160);
+	static_assert(oel::growth_size_class::round_up_bytes(257) == 320);
+	static_assert(oel::growth_size_class::round_up_bytes(4097) == 5120);
+	static_assert(oel::growth_size_class::round_up_bytes(SIZE_MAX - 5) == SIZE_MAX - 5);
+	static_assert(oel::growth_size_class::grow(0, SIZE_MAX - 5, 1) == SIZE_MAX - 5);
+	static_assert(oel::growth_size_class::grow(0, SIZE_MAX / 3, 2) == SIZE_MAX / 3);
+	static_assert(oel::growth_size_class::grow_one(SIZE_MAX / 3, 1) >= SIZE_MAX / 3);
+
+	template< typename T >
+	struct SizeClassAlloc : TrackingAllocator<T>
+	{
+		using growth_policy = oel::growth_size_class;
+
+		static constexpr bool   can_reallocate()  { return false; }
+		static constexpr size_t max_size()  { return SIZE_MAX / sizeof(T); }
+
+		T * allocate(size_t n)
+		{
+			if (n > 1000)
+				OEL_THROW(std::bad_alloc{}, "");
+
+			return TrackingAllocator<T>::allocate(n);
+		}
+	};
+}
+
+TEST(dynarrayOtherTest, growthPolicy)
+{
+	dynarray< int, Growth3Over2Alloc<int> > d;
+	d.push_back(0);
+	EXPECT_EQ(6U, d.capacity());
+
+	d.resize(6);
+	d.push_back(1);
+	EXPECT_EQ(12U, d.capacity()); // grows at least 24 bytes
+
+	d.resize(12);
+	d.push_back(2);
+	EXPECT_EQ(18U, d.capacity());
+
+	d.reserve(19);
+	EXPECT_EQ(27U, d.capacity());
+}
+
+TEST(dynarrayOtherTest, growthSizeClassNearMaxSize)
+{
+	dynarray< char, SizeClassAlloc<char> > d;
+	d.push_back(1);
+	EXPECT_EQ(32U, d.capacity());
+#if OEL_HAS_EXCEPTIONS
+	EXPECT_THROW(d.reserve(d.max_size()), std::bad_alloc);
+	EXPECT_THROW(d.reserve(d.max_size() - 5), std::bad_alloc);
+	EXPECT_THROW(d.reserve(SIZE_MAX / 2 + 1), std::bad_alloc);
+	EXPECT_EQ(1U, d.size());
+#endif
+}
+
+TEST(dynarrayOtherTest, allocateAtLeast)
+{
+	auto r = oel::allocator<char>::allocate_at_least(5);
+	ASSERT_TRUE(r.ptr);
+	EXPECT_LE(5U, r.count);
+	auto const last = r.count - 1;
+	r.ptr[last] = 'a';
+
+	r = oel::allocator<char>::reallocate_at_least(r.ptr, r.count + 1);
+	EXPECT_LT(last + 1, r.count);
+	EXPECT_EQ('a', r.ptr[last]);
+	oel::allocator<char>::deallocate(r.ptr, r.count);
+
+	auto const d = dynarray<char>(oel::reserve, 1);
+	EXPECT_LE(1U, d.capacity());
+	auto const d2 = dynarray<char>(3);
+	EXPECT_EQ(3U, d2.size());
+}
+
+namespace
+{
+	int g_nAllocateZeroed;
+
+	template< typename T >
+	struct ZeroedCountAlloc : TrackingAllocator<T>
+	{
+		T * allocate_zeroed(size_t n)
+		{
+			++g_nAllocateZeroed;
+			++g_allocCount.nAllocations;
+			auto const p = oel::allocator<T>::allocate_zeroed(n);
+			g_allocCount.sizeFromPtr[p] = n;
+			return p;
+		}
+	};
+
+	template< typename T >
+	struct ZeroedNoReallocAlloc : ZeroedCountAlloc<T>
+	{
+		static constexpr bool can_reallocate()  { return false; }
+	};
+
+	struct HasMemberPtr { int x; };
+}
+
+TEST(dynarrayOtherTest, allocateZeroed)
+{
+	auto p = oel::allocator<long>::allocate_zeroed(5000);
+	EXPECT_EQ(0, p[0]);
+	EXPECT_EQ(0, p[4999]);
+	oel::allocator<long>::deallocate(p, 5000);
+
+	g_nAllocateZeroed = 0;
+	{
+		dynarray< double, ZeroedCountAlloc<double> > d(100);
+		EXPECT_EQ(1, g_nAllocateZeroed);
+		EXPECT_EQ(0, d[99]);
+
+		d[99] = 1;
+		d.resize(1000); // realloc
+		EXPECT_EQ(1, g_nAllocateZeroed);
+		EXPECT_EQ(1000U, d.size());
+		EXPECT_EQ(1, d[99]);
+		EXPECT_EQ(0, d[999]);
+
+		d.resize(10);
+		d.resize(20);
+		EXPECT_EQ(1, g_nAllocateZeroed);
+		EXPECT_EQ(0, d[19]);
+
+		dynarray< double, ZeroedCountAlloc<double> > fresh;
+		fresh.resize(5);
+		EXPECT_EQ(2, g_nAllocateZeroed);
+		EXPECT_EQ(0, fresh[4]);
+
+		dynarray< double, ZeroedNoReallocAlloc<double> > noRealloc(2);
+		noRealloc[1] = 1;
+		noRealloc.resize(100);
+		EXPECT_EQ(4, g_nAllocateZeroed);
+		EXPECT_EQ(1, noRealloc[1]);
+		EXPECT_EQ(0, noRealloc[99]);
+
+		dynarray< std::string, ZeroedCountAlloc<std::string> > s(2);
+		s.resize(100);
+		EXPECT_EQ(4, g_nAllocateZeroed);
+
+		dynarray< int HasMemberPtr::*, ZeroedCountAlloc<int HasMemberPtr::*> > m(3);
+		m.resize(9);
+		EXPECT_EQ(4, g_nAllocateZeroed);
+		EXPECT_TRUE(m[0] == nullptr);
+		EXPECT_TRUE(m[8] == nullptr);
+	}
+	using A = oel::large_block_allocator<int, 4096>;
+	dynarray<int, A> d(4000);
+	d.back() = 3;
+	d.resize(1'000'000);
+	EXPECT_EQ(3, d[3999]);
+	EXPECT_EQ(0, d.back());
+
+	dynarray<int, std::allocator<int>> d2(3);
+	d2.resize(50);
+	EXPECT_EQ(0, d2[49]);
+}
+
+TEST(dynarrayOtherTest, largeBlockAllocator)
+{
+	using A = oel::large_block_allocator<int, 4096>;
+	static_assert(oel::allocator_can_realloc<A>());
+
+	dynarray<int, A> d;
+	for (int i = 0; i < 10'000; ++i)
+		d.push_back(i);
+
+	EXPECT_EQ(9'999, d.back());
+	d.resize(100);
+	d.shrink_to_fit();
+	EXPECT_EQ(100U, d.size());
+	EXPECT_EQ(99, d.back());
+
+	d.append_range(oel::view::counted(dynarray<int>(5000).cbegin(), 5000));
+	EXPECT_EQ(5100U, d.size());
+	EXPECT_EQ(99, d[99]);
+	EXPECT_EQ(0, d.back());
+
+	auto p = A::allocate(2000);
+	p[1999] = 7;
+	p = A::reallocate(p, 2000, 1'000'000);
+	EXPECT_EQ(7, p[1999]);
+	A::deallocate(p, 1'000'000);
+}
+
+TEST(dynarrayOtherTest, largeBlockHugePages)
+{
+	using Opt = oel::large_block_option;
+	using A = oel::large_block_allocator<float, 4096, Opt::huge_pages | Opt::prefault>;
+
+	auto p = A::allocate(1'000'000);
+#if OEL_HAS_MREMAP
+	EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(p) % (size_t{1} << 21));
+#endif
+	p[0] = 1;
+	p[999'999] = 2;
+	p = A::reallocate(p, 1'000'000, 3'000'000);
+	EXPECT_EQ(1, p[0]);
+	EXPECT_EQ(2, p[999'999]);
+	EXPECT_EQ(0, p[2'999'999]);
+	A::deallocate(p, 3'000'000);
+
+	dynarray<float, A> d(oel::reserve, 600'000);
+	d.append_range(oel::view::repeat(5.f, 3));
+	oel::prefault_spare_capacity(d);
+	oel::prefault_spare_capacity(d);
+	d.resize_for_overwrite(d.capacity());
+	EXPECT_EQ(5, d[2]);
+
+	dynarray<int> small(oel::reserve, 10);
+	small.push_back(9);
+	oel::prefault_spare_capacity(small);
+	EXPECT_EQ(9, small[0]);
+}
+
+#if HAS_STD_PMR
+TEST(dynarrayOtherTest, pmrRealloc)
+{
+	using oel::pmr::realloc_dynarray;
+	static_assert(oel::allocator_can_realloc< oel::pmr::realloc_polymorphic_allocator<int> >());
+	{
+		oel::pmr::monotonic_realloc_resource res{1 << 16};
+		realloc_dynarray<int> a(oel::reserve, 1, &res);
+		auto const p = a.data();
+		for (int i = 0; i < 10'000; ++i)
+			a.push_back(i);
+
+		EXPECT_EQ(p, a.data());
+		// b is now the last block, so a has to move
+		realloc_dynarray<int> b(oel::reserve, 1, &res);
+		auto const pb = b.data();
+		b.push_back(-1);
+		for (int i = 0; i < 1000; ++i)
+			b.push_back(i);
+		EXPECT_EQ(pb, b.data());
+
+		a.resize(20'000);
+		EXPECT_NE(p, a.data());
+		EXPECT_EQ(9'999, a[9'999]);
+		EXPECT_EQ(0, a.back());
+		EXPECT_EQ(-1, b[0]);
+
+		realloc_dynarray<int> c(a);
+		EXPECT_EQ(oel::pmr::malloc_resource(), c.get_allocator().resource());
+		EXPECT_TRUE(c == a);
+		EXPECT_TRUE(c.get_allocator() != a.get_allocator());
+	}
+	struct alignas(64) Over { double d; };
+
+	realloc_dynarray<double> d;
+	realloc_dynarray<Over> e;
+	for (int i = 0; i < 1000; ++i)
+	{
+		d.push_back(i);
+		e.push_back({0.5 * i});
+	}
+	EXPECT_EQ(999.0, d.back());
+	EXPECT_EQ(499.5, e.back().d);
+	EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(e.data()) % 64);
+	d.shrink_to_fit();
+	EXPECT_EQ(1000U, d.capacity());
+}
+#endif
+
+TEST(dynarrayOtherTest, arenaAllocator)
+{
+	using A = oel::arena_allocator<int>;
+	static_assert(oel::allocator_can_realloc<A>());
+	static_assert(oel::is_trivially_relocatable<A>::value);
+
+	oel::arena ar{1 << 16};
+	{
+		oel::arena::frame f{ar};
+		dynarray<int, A> a(oel::reserve, 1, ar);
+		auto const p = a.data();
+		for (int i = 0; i < 5000; ++i)
+			a.push_back(i);
+
+		EXPECT_EQ(p, a.data());
+		// b is the most recent allocation, so a has to be copied
+		dynarray<double, oel::arena_allocator<double>> b(oel::reserve, 1, ar);
+		b.push_back(0.5);
+		a.resize(10'000);
+		EXPECT_NE(p, a.data());
+		EXPECT_EQ(4999, a[4999]);
+		EXPECT_EQ(0, a.back());
+		EXPECT_EQ(0.5, b[0]);
+		EXPECT_TRUE(a.get_allocator() == b.get_allocator());
+
+		struct alignas(64) Over { double d; };
+		dynarray<Over, oel::arena_allocator<Over>> c(3, ar);
+		EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(c.data()) % 64);
+
+		auto const largeChunk = ar.chunk_bytes();
+		{
+			oel::arena::frame inner{ar};
+			dynarray<char, oel::arena_allocator<char>> big(1'000'000, ar);
+			EXPECT_LT(largeChunk + 1'000'000, ar.chunk_bytes());
+		}
+		EXPECT_EQ(largeChunk, ar.chunk_bytes());
+		a.push_back(7);
+		EXPECT_EQ(7, a.back());
+	}
+	dynarray<int, A> d(100, ar);
+	oel::arena ar2;
+	dynarray<int, A> e(std::move(d), ar2);
+	EXPECT_EQ(100U, e.size());
+	e = std::move(d);
+	EXPECT_EQ(&ar, &e.get_allocator().get_arena());
+
+	auto p = static_cast<char *>( ar2.allocate(10, 1) );
+	std::memset(p, 1, 10);
+	p = static_cast<char *>( ar2.reallocate(p, 10, 1000, 1) );
+	EXPECT_EQ(1, p[9]);
+	ar2.deallocate(p, 1000);
+	EXPECT_EQ(p, ar2.allocate(1, 1));
+	ar2.reset();
+	EXPECT_EQ(p, ar2.allocate(1, 1));
+}
+
+TEST(dynarrayOtherTest, poolAllocator)
+{
+	using A = oel::pool_allocator<int>;
+	static_assert(oel::allocator_can_realloc<A>());
+
+	dynarray<int, A> d;
+	d.push_back(0);
+	auto const cap = d.capacity();
+	EXPECT_EQ(0U, sizeof(int) * cap % 16);
+	for (int i = 1; i < 100'000; ++i)
+		d.push_back(i);
+
+	EXPECT_EQ(99'999, d.back());
+	d.resize(3);
+	d.shrink_to_fit();
+	EXPECT_EQ(2, d.back());
+	d.resize(cap);
+	d.shrink_to_fit();
+	EXPECT_EQ(cap, d.capacity());
+
+	auto r = A::allocate_at_least(5);
+	EXPECT_EQ(8U, r.count);
+	auto r2 = A::reallocate_at_least(r.ptr, r.count, 7);
+	EXPECT_EQ(r.ptr, r2.ptr);
+	A::deallocate(r2.ptr, r2.count);
+	EXPECT_EQ(r.ptr, A::allocate(8));
+	A::deallocate(r.ptr, 8);
+
+	// Allocate on some threads, free on others
+	constexpr int nThreads = 4;
+	dynarray< dynarray<int, A> > made[nThreads];
+	std::thread threads[nThreads];
+	for (int t = 0; t < nThreads; ++t)
+	{
+		threads[t] = std::thread{[&v = made[t], t]
+		{
+			for (int i = 0; i < 2000; ++i)
+			{
+				v.emplace_back().append_range(oel::view::repeat(t, i % 50 + 1));
+				if (i % 3 == 0)
+					v.pop_back();
+			}
+		}};
+	}
+	for (auto & th : threads)
+		th.join();
+
+	for (int t = 0; t < nThreads; ++t)
+	{
+		threads[t] = std::thread{[&v = made[(t + 1) % nThreads], t]
+		{
+			int const val = (t + 1) % nThreads;
+			for (auto & e : v)
+			{
+				EXPECT_EQ(val, e.back());
+				e = {};
+			}
+			dynarray<int, A> mine(oel::reserve, 20);
+			mine.push_back(1);
+			EXPECT_EQ(1, mine[0]);
+		}};
+	}
+	for (auto & th : threads)
+		th.join();
+}
+
+TEST(dynarrayOtherTest, statsAllocator)
+{
+	// Local types, so that the counters start at zero
+	struct Elem { int a, b; };
+	using A = oel::stats_allocator<Elem>;
+	static_assert(oel::allocator_can_realloc<A>());
+	{
+		dynarray<Elem, A> d;
+		for (int i = 0; i < 100; ++i)
+			d.push_back({i, i});
+
+		d.insert(d.begin(), Elem{});
+		d.shrink_to_fit();
+		auto const s = oel::allocation_stats_of<Elem>();
+		EXPECT_EQ(sizeof(Elem), s.element_size);
+		EXPECT_EQ(s.allocations + s.reallocations, s.capacity_changes);
+		EXPECT_EQ(1U, s.allocations);
+		EXPECT_EQ(0U, s.deallocations);
+		EXPECT_LE(s.in_place_reallocations, s.reallocations);
+		EXPECT_LE(sizeof(Elem) * d.capacity(), s.bytes_in_use);
+		EXPECT_LE(s.bytes_in_use, s.peak_bytes);
+	}
+	auto s = oel::allocation_stats_of<Elem>();
+	EXPECT_EQ(1U, s.deallocations);
+	EXPECT_EQ(0U, s.bytes_in_use);
+
+	struct InVector { int i; };
+	{
+		std::vector< InVector, oel::stats_allocator<InVector> > v;
+		for (int i = 0; i < 100; ++i)
+			v.push_back({i});
+	}
+	EXPECT_EQ(0U, oel::allocation_stats_of<InVector>().bytes_in_use);
+
+	struct Assigned { int i; };
+	{
+		dynarray< Assigned, oel::stats_allocator<Assigned> > d(oel::reserve, 1);
+		d.assign_range(oel::view::repeat(Assigned{1}, 50));
+		s = oel::allocation_stats_of<Assigned>();
+		EXPECT_EQ(2U, s.allocations);
+		EXPECT_EQ(1U, s.capacity_changes);
+		EXPECT_EQ(0U, s.bytes_relocated);
+	}
+
+	struct Small { int i; };
+	using B = oel::stats_allocator< Small, std::allocator<Small> >;
+	static_assert(!oel::allocator_can_realloc<B>());
+	static_assert(std::is_same_v< oel::growth_factor<2, 1>, B::growth_policy >);
+
+	dynarray<Small, B> d(oel::reserve, 2);
+	d.push_back({1});
+	d.push_back({2});
+	d.push_back({3});
+	d.insert(d.begin(), {0});
+
+	s = oel::allocation_stats_of<Small>();
+	EXPECT_EQ(s.allocations, s.capacity_changes + 1);
+	EXPECT_EQ(s.allocations, s.deallocations + 1);
+	ASSERT_EQ(1U, s.capacity_changes);
+	EXPECT_EQ(sizeof(Small) * 2, s.bytes_relocated);
+	EXPECT_EQ(sizeof(Small) * (d.capacity() - 3), s.slack_bytes);
+
+	int nTypes{};
+	oel::for_each_allocation_stats([&](const oel::allocation_stats & x)
+	{
+		if (x.element_size == sizeof(Small) and x.allocations == s.allocations)
+			++nTypes;
+	});
+	EXPECT_LE(1, nTypes);
+
+	auto const f = std::tmpfile();
+	ASSERT_TRUE(f);
+	oel::print_allocation_stats(f);
+	EXPECT_LT(0, std::ftell(f));
+	std::fclose(f);
+}
+
+TEST(dynarrayOtherTest, statsAllocatorSizeAfterOperation)
+{
+	struct Elem { int i; };
+	using A = oel::stats_allocator< Elem, std::allocator<Elem> >;
+
+	oel::allocation_stats prev{};
+	auto change = [&prev]
+	{
+		auto const s = oel::allocation_stats_of<Elem>();
+		std::pair<std::uint64_t, std::uint64_t> r{s.bytes_relocated - prev.bytes_relocated, s.slack_bytes - prev.slack_bytes};
+		prev = s;
+		return r;
+	};
+	using P = std::pair<std::uint64_t, std::uint64_t>;
+	constexpr std::uint64_t n = sizeof(Elem);
+
+	dynarray<Elem, A> d(oel::reserve, 2);
+	d.push_back({0});
+	d.push_back({1});
+	EXPECT_EQ(P(0, 0), change());
+
+	d.push_back({2});
+	EXPECT_EQ(P(n * 2, n * (d.capacity() - 3)), change());
+
+	while (d.size() < d.capacity())
+		d.push_back({3});
+	change();
+	auto s = d.size();
+	d.insert(d.begin() + 1, Elem{4});
+	EXPECT_EQ(P(n * s, n * (d.capacity() - s - 1)), change());
+
+	s = d.size();
+	d.resize(d.capacity() + 5);
+	EXPECT_EQ(P(n * s, n * (d.capacity() - d.size())), change());
+
+	d.assign_range(oel::view::repeat(Elem{5}, d.capacity() + 1));
+	EXPECT_EQ(P(0, n * (d.capacity() - d.size())), change());
+
+	// Growing in place with realloc, the elements after an insert are still moved
+	struct Realloced { int i; };
+	dynarray< Realloced, oel::stats_allocator<Realloced> > r(oel::reserve, 4);
+	r.resize(r.capacity());
+	auto const nAfter = r.size();
+	r.insert(r.begin(), Realloced{});
+	EXPECT_LE(sizeof(Realloced) * nAfter, oel::allocation_stats_of<Realloced>().bytes_relocated);
+}
+
+TEST(dynarrayOtherTest, learnedCapacity)
+{
+	struct Elem { int i; };
+	using A = oel::stats_allocator<Elem, std::allocator<Elem>>;
+
+	auto build = [](int n)
+	{
+		static oel::learned_capacity site;
+		auto d = site.make< dynarray<Elem, A> >();
+		for (int i = 0; i < n; ++i)
+			d.push_back({i});
+
+		site.record(d.size());
+		return site.hint();
+	};
+	EXPECT_EQ(1000U, build(1000));
+	auto const first = oel::allocation_stats_of<Elem>();
+	EXPECT_LT(5U, first.capacity_changes);
+
+	for (int k = 0; k < 10; ++k)
+		build(1000 - k);
+
+	auto const after = oel::allocation_stats_of<Elem>();
+	EXPECT_EQ(first.capacity_changes, after.capacity_changes);
+	EXPECT_EQ(first.bytes_relocated, after.bytes_relocated);
+	EXPECT_EQ(first.allocations + 10, after.allocations);
+
+	EXPECT_EQ(1000U, build(1000));
+	EXPECT_EQ(1000U - (1000 - 200) / 8, build(200));
+	EXPECT_EQ(2000U, build(2000));
+
+	oel::learned_capacity other;
+	EXPECT_EQ(0U, other.hint());
+	auto d = other.make< dynarray<int> >();
+	EXPECT_EQ(0U, d.capacity());
+	other.record(5);
+	d = other.make< dynarray<int> >(oel::allocator<int>{});
+	EXPECT_LE(5U, d.capacity());
+}
+
+TEST(dynarrayOtherTest, adoptAndRelease)
+{
+	auto const p = static_cast<int *>( std::malloc(sizeof(int) * 8) );
+	for (int i = 0; i < 5; ++i)
+		p[i] = i;
+
+	dynarray<int> d{-1};
+	d.adopt({p, 5, 8});
+	ASSERT_EQ(5U, d.size());
+	EXPECT_LE(8U, d.capacity()); // more with OEL_MEM_BOUND_DEBUG_LVL, from allocate_at_least
+	EXPECT_EQ(4, d.back());
+	d.push_back(5);
+	EXPECT_EQ(5, d[5]);
+
+	auto const cap = d.capacity();
+	auto b = d.release();
+	EXPECT_TRUE(d.empty());
+	EXPECT_EQ(0U, d.capacity());
+	EXPECT_EQ(6U, b.size);
+	EXPECT_EQ(cap, b.capacity);
+	EXPECT_EQ(3, b.data[3]);
+	d.get_allocator().deallocate(b.data, b.capacity);
+
+	struct alignas(64) Aligned { int i; };
+	dynarray<Aligned> src{Aligned{1}, Aligned{2}};
+	dynarray<Aligned> dest;
+	dest.adopt(src.release());
+	EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(dest.data()) % 64);
+	EXPECT_EQ(2, dest[1].i);
+
+	dynarray<std::string> strings;
+	strings.adopt({});
+	EXPECT_TRUE(strings.empty());
+	strings.append_range(oel::view::repeat(std::string(40, 'a'), 3));
+	auto sb = strings.release();
+	strings.adopt(sb);
+	EXPECT_EQ(3U, strings.size());
+	EXPECT_EQ(40U, strings[2].size());
+}
+
 TEST(dynarrayOtherTest, allocAndIterEquality)
 {
 	oel::allocator<> a;
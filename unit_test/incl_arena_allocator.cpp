@@ -0,0 +1 @@
+#include "arena_allocator.h"
@@ -0,0 +1 @@
+#include "compact_dynarray.h"
@@ -0,0 +1 @@
+#include "growth_policy.h"
@@ -0,0 +1 @@
+#include "large_block_allocator.h"
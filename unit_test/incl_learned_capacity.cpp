@@ -0,0 +1 @@
+#include "learned_capacity.h"
@@ -0,0 +1 @@
+#include "pool_allocator.h"
@@ -0,0 +1 @@
+#include "soa_dynarray.h"
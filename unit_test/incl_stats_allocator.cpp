@@ -0,0 +1 @@
+#include "stats_allocator.h"
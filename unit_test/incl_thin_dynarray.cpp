@@ -0,0 +1 @@
+#include "thin_dynarray.h"
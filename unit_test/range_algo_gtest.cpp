@@ -13,6 +13,8 @@
 #include <array>
 #include <valarray>
 #include <string_view>
+#include <cstdint>
+#include <limits>
 
 namespace view = oel::view;
 
@@ -79,6 +81,148 @@ TEST(rangeTest, eraseAdjacentDup)
 	EXPECT_FALSE(uniqueTest != expect);
 }
 
+TEST(rangeTest, eraseIfRelocating)
+{
+	MyCounter::clearCount();
+	{
+		oel::dynarray<TrivialRelocat> d;
+		for (int i = 0; i < 10; ++i)
+			d.emplace_back(i);
+
+		auto const nConstruct = TrivialRelocat::nConstructions;
+		auto n = d.remove_if([](const TrivialRelocat & x) { return *x < 2 or int(*x) % 3 == 0; });
+		EXPECT_EQ(nConstruct, TrivialRelocat::nConstructions);
+		EXPECT_EQ(5U, n);
+		double const expect[]{2, 4, 5, 7, 8};
+		ASSERT_EQ(5U, d.size());
+		for (int i = 0; i < 5; ++i)
+			EXPECT_EQ(expect[i], *d[i]);
+
+		EXPECT_EQ(0U, d.remove_if([](const TrivialRelocat &) { return false; }));
+		EXPECT_EQ(5U, d.size());
+
+	#if OEL_HAS_EXCEPTIONS
+		EXPECT_THROW(
+			d.remove_if([](const TrivialRelocat & x) { if (*x == 7) throw TestException{}; return *x == 4; }),
+			TestException );
+		ASSERT_EQ(4U, d.size());
+		EXPECT_EQ(5, *d[1]);
+		EXPECT_EQ(8, *d.back());
+	#endif
+		erase_if(d, [](const TrivialRelocat &) { return true; });
+		EXPECT_TRUE(d.empty());
+	}
+	EXPECT_EQ(TrivialRelocat::nConstructions, TrivialRelocat::nDestruct);
+}
+
+TEST(rangeTest, uniqueRelocating)
+{
+	auto const two = std::make_shared<int>(2);
+	auto const three = std::make_shared<int>(3);
+	oel::dynarray< std::shared_ptr<int> > d{nullptr, nullptr, two, two, two, nullptr, three, three};
+
+	EXPECT_EQ(4U, d.unique());
+	ASSERT_EQ(4U, d.size());
+	EXPECT_EQ(nullptr, d[0]);
+	EXPECT_EQ(two, d[1]);
+	EXPECT_EQ(nullptr, d[2]);
+	EXPECT_EQ(three, d[3]);
+	EXPECT_EQ(2, two.use_count());
+	EXPECT_EQ(0U, d.unique());
+
+	oel::dynarray<std::string> s{"a", "a", "b", "b", "a"};
+	oel::erase_adjacent_dup(s);
+	EXPECT_EQ((oel::dynarray<std::string>{"a", "b", "a"}), s);
+}
+
+template< typename T, typename Compare >
+void testFilterCompareWith(Compare comp)
+{
+	using oel::dynarray;
+
+	dynarray<T> src;
+	for (int i = 0; i < 77; ++i)
+		src.push_back(static_cast<T>( (i * 37) % 23 ) - static_cast<T>(std::is_signed_v<T> ? 11 : 0));
+	T const value = src[5];
+	auto const pred = oel::compare_with{comp, value};
+
+	dynarray<T> expect;
+	for (T x : src)
+		if (!comp(x, value))
+			expect.push_back(x);
+
+	dynarray<T> d(src);
+	oel::erase_if(d, pred);
+	EXPECT_EQ(expect, d);
+
+	dynarray<T> kept{T{1}};
+	oel::append_if(kept, src, pred);
+	ASSERT_EQ(1 + src.size() - expect.size(), kept.size());
+	for (size_t i = 1; i < kept.size(); ++i)
+		EXPECT_TRUE(comp(kept[i], value));
+
+	using namespace oel::_detail;
+	constexpr auto op = CmpOpOf<T, Compare>();
+	static_assert(op != CmpOp::none);
+	dynarray<T> out(src.size());
+	auto n = CompressScalar<op>(src.data(), src.size(), out.data(), value, false, 0, 0);
+	EXPECT_TRUE(std::equal(expect.begin(), expect.end(), out.begin(), out.begin() + n));
+#if OEL_HAS_SIMD_COMPRESS
+	if (__builtin_cpu_supports("avx2"))
+	{
+		n = CompressAvx2<op>(src.data(), src.size(), out.data(), value, false);
+		EXPECT_TRUE(std::equal(expect.begin(), expect.end(), out.begin(), out.begin() + n));
+	}
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		n = CompressAvx512<op>(src.data(), src.size(), out.data(), value, false);
+		EXPECT_TRUE(std::equal(expect.begin(), expect.end(), out.begin(), out.begin() + n));
+	}
+#endif
+}
+
+template< typename T >
+void testFilterAllCompare()
+{
+	testFilterCompareWith<T>(std::less<>{});
+	testFilterCompareWith<T>(std::less_equal<T>{});
+	testFilterCompareWith<T>(std::greater<>{});
+	testFilterCompareWith<T>(std::greater_equal<>{});
+	testFilterCompareWith<T>(std::equal_to<T>{});
+	testFilterCompareWith<T>(std::not_equal_to<>{});
+}
+
+TEST(rangeTest, eraseIfSimd)
+{
+	testFilterAllCompare<float>();
+	testFilterAllCompare<double>();
+	testFilterAllCompare<std::int32_t>();
+	testFilterAllCompare<std::uint32_t>();
+	testFilterAllCompare<std::int64_t>();
+	testFilterAllCompare<std::uint64_t>();
+
+	oel::dynarray<std::uint32_t> big{0x8000'0000u, 1, 0xFFFF'FFFFu, 2};
+	oel::erase_if(big, oel::compare_with{std::greater<>{}, 0x7FFF'FFFFu});
+	EXPECT_EQ((oel::dynarray<std::uint32_t>{1, 2}), big);
+
+	// NaN compares false except with not_equal_to, same as the scalar operators
+	float const nan = std::numeric_limits<float>::quiet_NaN();
+	oel::dynarray<float> f(oel::from_range, view::repeat(nan, 20));
+	f[3] = 1;
+	oel::erase_if(f, oel::compare_with{std::less<>{}, 2.f});
+	EXPECT_EQ(19U, f.size());
+	oel::erase_if(f, oel::compare_with{std::not_equal_to<>{}, 2.f});
+	EXPECT_TRUE(f.empty());
+
+	// Not recognized, but works the same
+	oel::dynarray<short> s{1, 5, 2};
+	oel::erase_if(s, oel::compare_with{std::greater<>{}, 1});
+	EXPECT_EQ(1U, s.size());
+	oel::dynarray<int> dest;
+	oel::append_if(dest, std::list<int>{4, 0, 5}, oel::compare_with{std::greater<>{}, 3});
+	EXPECT_EQ((oel::dynarray<int>{4, 5}), dest);
+}
+
 TEST(rangeTest, concatToDynarray)
 {
 	using namespace std::string_view_literals;
@@ -0,0 +1,125 @@
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "test_classes.h"
+#include "segmented_array.h"
+#include "view/counted.h"
+
+#include <string>
+
+using oel::segmented_array;
+
+namespace
+{
+#if __cpp_lib_concepts >= 201907
+	static_assert(std::random_access_iterator< segmented_array<int>::iterator >);
+	static_assert(std::random_access_iterator< segmented_array<int>::const_iterator >);
+#endif
+	static_assert(std::is_convertible_v< segmented_array<int>::iterator, segmented_array<int>::const_iterator >);
+}
+
+class segmentedArrayTest : public ::testing::Test
+{
+protected:
+	segmentedArrayTest()
+	{
+		g_allocCount.clear();
+	}
+
+	~segmentedArrayTest()
+	{
+		EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+		EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+
+		g_allocCount.clear();
+		MyCounter::clearCount();
+	}
+};
+
+TEST_F(segmentedArrayTest, stableAddresses)
+{
+	segmented_array< int, TrackingAllocator<int> > a;
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+
+	a.push_back(0);
+	int * first = &a[0];
+	for (int i = 1; i < 10'000; ++i)
+		a.push_back(i);
+
+	EXPECT_EQ(first, &a.front());
+	ASSERT_EQ(10'000U, a.size());
+	for (int i = 0; i < 10'000; ++i)
+		ASSERT_EQ(i, a[i]);
+
+	int i = 0;
+	for (int v : a)
+		EXPECT_EQ(i++, v);
+
+	EXPECT_EQ(10'000, a.end() - a.begin());
+	EXPECT_EQ(9'999, a.begin()[9'999]);
+	EXPECT_EQ(5'000, *(a.cend() - 5'000));
+}
+
+TEST_F(segmentedArrayTest, appendAndResize)
+{
+	segmented_array<double> a;
+	oel::dynarray<double> src(1000);
+	for (size_t i = 0; i < src.size(); ++i)
+		src[i] = double(i);
+
+	a.append_range(src);
+	a.append_range(src);
+	ASSERT_EQ(2000U, a.size());
+	EXPECT_EQ(999, a[999]);
+	EXPECT_EQ(0, a[1000]);
+	EXPECT_EQ(999, a.back());
+
+	a.resize(10);
+	EXPECT_EQ(9, a.back());
+	a.resize(3000);
+	EXPECT_EQ(0, a.back());
+	EXPECT_EQ(9, a[9]);
+
+	a.clear();
+	auto const cap = a.capacity();
+	EXPECT_LE(3000U, cap);
+	a.push_back(1);
+	EXPECT_EQ(cap, a.capacity());
+
+	a.shrink_to_fit();
+	EXPECT_GT(cap, a.capacity());
+	a.pop_back();
+	a.shrink_to_fit();
+	EXPECT_EQ(0U, a.capacity());
+	a.push_back(2);
+	EXPECT_EQ(2, a.at(0));
+}
+
+TEST_F(segmentedArrayTest, nonMovableLikeElements)
+{
+	{
+		segmented_array<TrivialRelocat> a;
+		for (int i = 0; i < 100; ++i)
+			a.emplace_back(i);
+
+		a.pop_back();
+		EXPECT_EQ(98.0, *a.back());
+
+		auto b = segmented_array<TrivialRelocat>(a);
+		EXPECT_EQ(99U, b.size());
+		EXPECT_EQ(50.0, *b[50]);
+
+		segmented_array<TrivialRelocat> c;
+		c = std::move(a);
+		EXPECT_TRUE(a.empty());
+		EXPECT_EQ(99U, c.size());
+
+		a = c;
+		EXPECT_EQ(1.0, *a[1]);
+	}
+	segmented_array<std::string> s{"a", "b"};
+	s.resize(100);
+	EXPECT_EQ("b", s[1]);
+	EXPECT_TRUE(s.back().empty());
+}
@@ -0,0 +1,189 @@
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "test_classes.h"
+#include "small_dynarray.h"
+#include "view/repeat.h"
+
+#include <string>
+
+using oel::small_dynarray;
+
+namespace
+{
+	template< typename T, size_t N >
+	using smallTrackingAlloc = small_dynarray< T, N, TrackingAllocator<T> >;
+
+	template< typename T, size_t N >
+	bool DataIsInside(const small_dynarray<T, N> & a)
+	{
+		auto const p = reinterpret_cast<const char *>(a.data());
+		auto const obj = reinterpret_cast<const char *>(&a);
+		return obj <= p and p < obj + sizeof a;
+	}
+}
+
+class smallDynarrayTest : public ::testing::Test
+{
+protected:
+	smallDynarrayTest()
+	{
+		g_allocCount.clear();
+	}
+
+	~smallDynarrayTest()
+	{
+		EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+		EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+
+		g_allocCount.clear();
+		MyCounter::clearCount();
+	}
+};
+
+TEST_F(smallDynarrayTest, noAllocationUpToN)
+{
+	smallTrackingAlloc<int, 4> a;
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(4U, a.capacity());
+
+	for (int i = 0; i < 4; ++i)
+		a.push_back(i);
+
+	EXPECT_TRUE(a.is_inline());
+	EXPECT_EQ(0, g_allocCount.nAllocations);
+
+	a.push_back(4);
+	EXPECT_FALSE(a.is_inline());
+	EXPECT_EQ(1, g_allocCount.nAllocations);
+	ASSERT_EQ(5U, a.size());
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(i, a[i]);
+}
+
+TEST_F(smallDynarrayTest, spillAndShrink)
+{
+	MyCounter::clearCount();
+	{
+		small_dynarray<TrivialRelocat, 2> a;
+		a.emplace_back(1.0);
+		a.emplace_back(2.0);
+		EXPECT_TRUE(DataIsInside(a));
+
+		a.emplace_back(3.0);
+		EXPECT_FALSE(DataIsInside(a));
+		EXPECT_LE(3U, a.capacity());
+
+		a.pop_back();
+		a.shrink_to_fit();
+		EXPECT_TRUE(DataIsInside(a));
+		EXPECT_EQ(2U, a.capacity());
+		EXPECT_EQ(1.0, *a[0]);
+		EXPECT_EQ(2.0, *a[1]);
+
+		a.append_range(oel::view::repeat(TrivialRelocat{4.0}, 3));
+		a.shrink_to_fit();
+		EXPECT_EQ(5U, a.capacity());
+		EXPECT_EQ(4.0, *a.back());
+	}
+	EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+}
+
+TEST_F(smallDynarrayTest, moveConstructAndAssign)
+{
+	MyCounter::clearCount();
+	{
+		small_dynarray<MoveOnly, 3> a;
+		a.emplace_back(1.0);
+		a.emplace_back(2.0);
+
+		auto b = std::move(a);
+		EXPECT_TRUE(a.empty());
+		EXPECT_TRUE(DataIsInside(b));
+		ASSERT_EQ(2U, b.size());
+		EXPECT_EQ(2.0, *b[1]);
+
+		for (int i = 0; i < 3; ++i)
+			b.emplace_back(i);
+
+		auto const heapData = b.data();
+		a = std::move(b);
+		EXPECT_EQ(heapData, a.data());
+		EXPECT_TRUE(b.empty());
+		EXPECT_TRUE(b.is_inline());
+		EXPECT_EQ(5U, a.size());
+
+		b.emplace_back(7.0);
+		a = std::move(b);
+		ASSERT_EQ(1U, a.size());
+		EXPECT_EQ(7.0, *a[0]);
+		EXPECT_TRUE(a.is_inline());
+	}
+	EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+}
+
+TEST_F(smallDynarrayTest, insertErase)
+{
+	smallTrackingAlloc<int, 4> a{1, 4};
+	auto it = a.insert(a.begin() + 1, 2);
+	EXPECT_EQ(2, *it);
+	int const src[]{3, 3};
+	it = a.insert_range(a.begin() + 2, src);
+	EXPECT_EQ(a.begin() + 2, it);
+	EXPECT_FALSE(a.is_inline());
+
+	it = a.erase(a.begin() + 2);
+	EXPECT_EQ(3, *it);
+	EXPECT_TRUE(( a == smallTrackingAlloc<int, 4>{1, 2, 3, 4} ));
+
+	a.erase(a.begin(), a.begin() + 2);
+	a.unordered_erase(a.begin());
+	ASSERT_EQ(1U, a.size());
+	EXPECT_EQ(4, a.front());
+}
+
+TEST_F(smallDynarrayTest, copyAndAssign)
+{
+	small_dynarray<std::string, 2> a{"a", "b", "c"};
+	auto b = small_dynarray<std::string, 2>(a);
+	EXPECT_TRUE(a == b);
+
+	b = {"x"};
+	EXPECT_TRUE(b.is_inline() or b.capacity() >= 3);
+	EXPECT_EQ("x", b.at(0));
+	b.assign_range(a);
+	EXPECT_TRUE(a == b);
+
+	auto c = small_dynarray<int, 8>(5);
+	EXPECT_EQ(5U, c.size());
+	EXPECT_EQ(0, c[4]);
+	c.resize(20);
+	EXPECT_EQ(0, c[19]);
+	c.clear();
+	EXPECT_TRUE(c.empty());
+}
+
+TEST_F(smallDynarrayTest, assignThrowingAlloc)
+{
+	smallTrackingAlloc<int, 2> a{1, 2, 3};
+	ASSERT_FALSE(a.is_inline());
+
+	std::vector<int> const src(a.capacity() + 1, 7);
+	g_allocCount.countToThrowOn = 0;
+	EXPECT_THROW(a.assign_range(src), TestException);
+	EXPECT_TRUE(a.empty());
+	EXPECT_TRUE(a.is_inline());
+
+	a.assign_range(src);
+	EXPECT_EQ(src.size(), a.size());
+	EXPECT_EQ(7, a.back());
+
+	smallTrackingAlloc<TrivialRelocat, 2> b{TrivialRelocat{1.0}, TrivialRelocat{2.0}, TrivialRelocat{3.0}};
+	ASSERT_FALSE(b.is_inline());
+
+	g_allocCount.countToThrowOn = 0;
+	auto const n = static_cast<std::ptrdiff_t>(b.capacity() + 1);
+	EXPECT_THROW(b.assign_range(oel::view::repeat(TrivialRelocat{4.0}, n)), TestException);
+	EXPECT_TRUE(b.empty());
+	EXPECT_TRUE(b.is_inline());
+}
@@ -0,0 +1,177 @@
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "test_classes.h"
+#include "soa_dynarray.h"
+#include "range_algo.h"
+
+#include <string>
+#include <utility>
+
+using oel::soa_dynarray;
+using oel::basic_soa_dynarray;
+
+// The columns share one block from an allocator rebound to an internal type
+using TrackAlloc = StatefulAllocator<int, true, false>;
+
+class soaDynarrayTest : public ::testing::Test
+{
+protected:
+	soaDynarrayTest()
+	{
+		g_allocCount.clear();
+	}
+
+	~soaDynarrayTest()
+	{
+		EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+		EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+
+		g_allocCount.clear();
+		MyCounter::clearCount();
+	}
+};
+
+TEST_F(soaDynarrayTest, emplaceBackAndColumns)
+{
+	basic_soa_dynarray< TrackAlloc, char, double, int > a;
+	EXPECT_TRUE(a.empty());
+
+	for (int i = 0; i < 100; ++i)
+		a.emplace_back(char('a' + i % 26), 0.5 * i, i);
+
+	ASSERT_EQ(100U, a.size());
+	EXPECT_LE(a.size(), a.capacity());
+	EXPECT_EQ(1, g_allocCount.nAllocations - g_allocCount.nDeallocations);
+
+	auto ints = a.column<2>();
+	EXPECT_EQ(100, ssize(ints));
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(i, ints[i]);
+		EXPECT_EQ(0.5 * i, a.data<1>()[i]);
+		EXPECT_EQ('a' + i % 26, a.data<0>()[i]);
+	}
+	EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(a.data<1>()) % alignof(double));
+	EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(a.data<2>()) % alignof(int));
+
+	auto [c, d, i] = a[7];
+	EXPECT_EQ('h', c);
+	EXPECT_EQ(3.5, d);
+	i = -7;
+	EXPECT_EQ(-7, a.data<2>()[7]);
+
+	a.pop_back();
+	EXPECT_EQ(99U, a.size());
+	EXPECT_EQ(98, std::get<2>(a.back()));
+
+	a.shrink_to_fit();
+	EXPECT_EQ(99U, a.capacity());
+	EXPECT_EQ(98, a.data<2>()[98]);
+	EXPECT_EQ(49.0, a.data<1>()[98]);
+
+	a.clear();
+	EXPECT_TRUE(a.empty());
+}
+
+TEST_F(soaDynarrayTest, rowIterator)
+{
+	soa_dynarray<int, std::string> a;
+	a.push_back(1, "one");
+	a.push_back(2, "two");
+	a.push_back(3, "three");
+
+	int sum{};
+	for (auto [n, s] : a)
+	{
+		sum += n;
+		s += '!';
+	}
+	EXPECT_EQ(6, sum);
+	EXPECT_EQ("three!", a.data<1>()[2]);
+
+	auto it = a.begin();
+	it += 2;
+	EXPECT_EQ(2, it - a.begin());
+	EXPECT_TRUE(a.begin() < it);
+	EXPECT_EQ(2, std::get<0>(it[-1]));
+
+	const auto & ca = a;
+	soa_dynarray<int, std::string>::const_iterator cit = a.end();
+	EXPECT_TRUE(cit == ca.end());
+	EXPECT_EQ(3, ca.end() - ca.begin());
+}
+
+TEST_F(soaDynarrayTest, appendRange)
+{
+	std::pair<int, std::string> const src[]
+		{	{1, "a"}, {2, "bb"}, {3, "ccc"}
+		};
+	soa_dynarray<int, std::string> a;
+	a.append_range(src);
+	a.append_range(src);
+	ASSERT_EQ(6U, a.size());
+	EXPECT_EQ(3, a.data<0>()[5]);
+	EXPECT_EQ("bb", a.data<1>()[4]);
+
+	soa_dynarray<int, std::string> b(a);
+	EXPECT_EQ(6U, b.size());
+	EXPECT_EQ("ccc", b.data<1>()[2]);
+
+	soa_dynarray<long, double> c;
+	std::tuple<int, float> const tuples[] { {1, 1.5f}, {2, 2.5f} };
+	c.append_range(tuples);
+	EXPECT_EQ(2L, c.data<0>()[1]);
+	EXPECT_EQ(2.5, c.data<1>()[1]);
+}
+
+TEST_F(soaDynarrayTest, appendRangeThrowing)
+{
+	using Row = std::tuple<double, double>;
+	Row const src[] { {1, 2}, {3, 4}, {5, 6} };
+
+	basic_soa_dynarray< TrackAlloc, MoveOnly, MoveOnly > a;
+	MyCounter::countToThrowOn = 3;
+	ASSERT_THROW(a.append_range(src), TestException);
+	EXPECT_EQ(1U, a.size());
+	EXPECT_EQ(2.0, *a.data<1>()[0]);
+
+	a.append_range(src);
+	EXPECT_EQ(4U, a.size());
+	EXPECT_EQ(6.0, *std::get<1>(a[3]));
+}
+
+TEST_F(soaDynarrayTest, resize)
+{
+	basic_soa_dynarray< TrackAlloc, int, TrivialRelocat > a;
+	a.resize(5);
+	EXPECT_EQ(5U, a.size());
+	for (int i : a.column<0>())
+		EXPECT_EQ(0, i);
+
+	MyCounter::countToThrowOn = 3;
+	ASSERT_THROW(a.resize(10), TestException);
+	EXPECT_EQ(5U, a.size());
+
+	a.resize(2);
+	EXPECT_EQ(2U, a.size());
+	EXPECT_EQ(2, MyCounter::nConstructions - MyCounter::nDestruct);
+}
+
+TEST_F(soaDynarrayTest, moveAndReserve)
+{
+	soa_dynarray<short, std::string> a(oel::reserve, 9);
+	EXPECT_EQ(9U, a.capacity());
+	a.push_back(1, "x");
+
+	auto b = std::move(a);
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+	EXPECT_EQ("x", b.data<1>()[0]);
+
+	a = std::move(b);
+	EXPECT_EQ(1U, a.size());
+	EXPECT_EQ(1, a.data<0>()[0]);
+
+	EXPECT_THROW(a.reserve(a.max_size() + 1), std::length_error);
+}
@@ -0,0 +1,136 @@
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "test_classes.h"
+#include "thin_dynarray.h"
+#include "view/repeat.h"
+
+#include <string>
+
+using oel::thin_dynarray;
+
+namespace
+{
+	static_assert(sizeof(thin_dynarray<int>) == sizeof(int *));
+
+	static_assert(oel::is_trivially_relocatable< thin_dynarray<std::string> >::value);
+}
+
+class thinDynarrayTest : public ::testing::Test
+{
+protected:
+	thinDynarrayTest()
+	{
+		g_allocCount.clear();
+	}
+
+	~thinDynarrayTest()
+	{
+		EXPECT_EQ(g_allocCount.nAllocations, g_allocCount.nDeallocations);
+		EXPECT_EQ(MyCounter::nConstructions, MyCounter::nDestruct);
+
+		g_allocCount.clear();
+		MyCounter::clearCount();
+	}
+};
+
+TEST_F(thinDynarrayTest, pushBackAndErase)
+{
+	thin_dynarray< int, TrackingAllocator<int> > a;
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+
+	for (int i = 0; i < 100; ++i)
+		a.push_back(i);
+
+	ASSERT_EQ(100U, a.size());
+	EXPECT_LE(100U, a.capacity());
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(i, a[i]);
+
+	a.erase(a.begin() + 1, a.begin() + 99);
+	ASSERT_EQ(2U, a.size());
+	EXPECT_EQ(99, a.back());
+
+	a.insert(a.begin() + 1, 5);
+	a.unordered_erase(a.begin());
+	EXPECT_EQ(99, a[0]);
+	EXPECT_EQ(5, a[1]);
+
+	a.pop_back();
+	a.shrink_to_fit();
+	EXPECT_EQ(1U, a.capacity());
+
+	a.clear();
+	EXPECT_TRUE(a.empty());
+}
+
+TEST_F(thinDynarrayTest, copyMoveAndSwap)
+{
+	thin_dynarray<std::string> a{"ab", "cd"};
+	auto b = thin_dynarray<std::string>(a);
+	EXPECT_TRUE(a == b);
+
+	auto c = std::move(a);
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(0U, a.capacity());
+	EXPECT_TRUE(b == c);
+
+	a = {"x"};
+	swap(a, c);
+	EXPECT_EQ(2U, a.size());
+	EXPECT_EQ("x", c.at(0));
+
+	c = std::move(a);
+	EXPECT_EQ("cd", c[1]);
+	a = c;
+	EXPECT_TRUE(a == c);
+}
+
+TEST_F(thinDynarrayTest, nested)
+{
+	oel::dynarray< thin_dynarray<int> > outer;
+	for (int i = 0; i < 50; ++i)
+		outer.emplace_back(oel::from_range, oel::view::repeat(i, 3));
+
+	outer.insert(outer.begin(), thin_dynarray<int>(2));
+	ASSERT_EQ(51U, outer.size());
+	EXPECT_EQ(0, outer[0][1]);
+	EXPECT_EQ(49, outer.back()[2]);
+}
+
+TEST_F(thinDynarrayTest, headerWithVariousElementSizes)
+{
+	thin_dynarray<char> a;
+	EXPECT_EQ(nullptr, a.data());
+	EXPECT_EQ(0U, a.capacity());
+
+	a.reserve(3);
+	EXPECT_TRUE(a.empty());
+	EXPECT_LE(3U, a.capacity());
+
+	for (char c = 'a'; c <= 'z'; ++c)
+		a.push_back(c);
+
+	EXPECT_EQ(26U, a.size());
+	EXPECT_EQ('z', a.back());
+
+	struct Odd { char c[5]; };
+	thin_dynarray<Odd> b(7);
+	b.emplace_back(Odd{{'x'}});
+	EXPECT_EQ(8U, b.size());
+	EXPECT_EQ('x', b.back().c[0]);
+	EXPECT_EQ(0, b[6].c[4]);
+
+	b.clear();
+	b.shrink_to_fit();
+	EXPECT_EQ(nullptr, b.data());
+	EXPECT_EQ(0U, b.size());
+
+	thin_dynarray<TrivialRelocat> c;
+	c.emplace_back(1.0);
+	c.resize(3);
+	c.pop_back();
+	EXPECT_EQ(2U, c.size());
+	EXPECT_EQ(1.0, *c[0]);
+}